@@ -0,0 +1,192 @@
+#! /usr/bin/env python3
+"""Convert the kernel's scheduler event trace to Chrome trace JSON.
+
+Open the output in chrome://tracing or https://ui.perfetto.dev.
+The kernel must be built with KERNEL_TRACE defined (see the top-level Makefile).
+
+The trace buffer can be read from:
+  --gdb      a target halted under a gdb server (QEMU or a hardware probe), read through gdb
+  --binary   a raw dump of the traceBuffer symbol, e.g. from gdb's "dump binary value trace.bin traceBuffer"
+  --usart    a captured console log containing the output of the DumpTrace kernel request
+
+The buffer layout must match src/os/trace/trace.hpp.
+"""
+
+import argparse
+import json
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+
+TRACE_BUFFER_MAGIC = 0x54524345
+# Magic, NumEntries, Head
+HEADER_FORMAT = "<III"
+# Timestamp, Type, Core, ThreadId, Arg
+EVENT_FORMAT = "<IBBHI"
+
+# TraceEventType
+CONTEXT_SWITCH, WAKE, BLOCK, IRQ_ENTER, IRQ_EXIT, SYSCALL_ENTER, SYSCALL_EXIT = range(7)
+
+# ThreadState
+THREAD_STATES = ["Created", "Ready", "Executing", "Blocked", "Sleeping", "Throttled", "Depleted", "Zombie", "Dead"]
+
+# Exception numbers below 16 are the core's own, the rest are device interrupts.
+EXCEPTION_NAMES = {11: "SVCall", 14: "PendSV", 15: "SysTick"}
+
+# Trace viewers only need a thread ID to be unique, put IRQs on their own track per core.
+IRQ_TRACK_BASE = 0x10000
+
+DEFAULT_CPU_HZ = 64000000
+
+
+def parse_binary(data):
+    """Return the events in a raw trace buffer dump, oldest first."""
+    header_size = struct.calcsize(HEADER_FORMAT)
+    event_size = struct.calcsize(EVENT_FORMAT)
+    magic, num_entries, head = struct.unpack_from(HEADER_FORMAT, data)
+    if magic != TRACE_BUFFER_MAGIC:
+        sys.exit("trace buffer magic is 0x%08x, expected 0x%08x - is the kernel built with KERNEL_TRACE?"
+                 % (magic, TRACE_BUFFER_MAGIC))
+    if len(data) < header_size + num_entries * event_size:
+        sys.exit("trace buffer dump is truncated")
+
+    num_events = min(head, num_entries)
+    events = []
+    for i in range(head - num_events, head):
+        offset = header_size + (i % num_entries) * event_size
+        events.append(struct.unpack_from(EVENT_FORMAT, data, offset))
+    return events
+
+
+def parse_usart(lines):
+    """Return the events from the last complete dump in a console log, oldest first."""
+    events = None
+    dump = None
+    for line in lines:
+        line = line.strip()
+        if line == "trace begin":
+            dump = []
+        elif line == "trace end":
+            if dump is not None:
+                events = dump
+            dump = None
+        elif dump is not None:
+            fields = line.split()
+            if len(fields) != 5:
+                # Other output mixed into the dump.
+                continue
+            dump.append(tuple(int(field, 16) for field in fields))
+    if events is None:
+        sys.exit("no complete trace dump found in the log")
+    return events
+
+
+def read_with_gdb(gdb, elf, port):
+    """Dump the trace buffer from a target halted under a gdb server."""
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, "trace.bin")
+        subprocess.run([gdb, "-batch", "-nx",
+                        "-ex", "target extended-remote localhost:%d" % port,
+                        "-ex", "dump binary value %s traceBuffer" % path,
+                        elf],
+                       check=True)
+        with open(path, "rb") as f:
+            return f.read()
+
+
+def exception_name(number):
+    if number in EXCEPTION_NAMES:
+        return EXCEPTION_NAMES[number]
+    if number >= 16:
+        return "IRQ %d" % (number - 16)
+    return "exception %d" % number
+
+
+def state_name(state):
+    return THREAD_STATES[state] if state < len(THREAD_STATES) else str(state)
+
+
+def to_chrome_trace(events, cpu_hz):
+    trace = []
+    threads = set()
+    cores = set()
+    running = {}  # core -> (thread, start)
+
+    last_cycles = None
+    wraps = 0
+    for timestamp, event_type, core, thread, arg in events:
+        # CYCCNT wraps every few minutes, unwrap it assuming events are never a whole wrap apart.
+        if last_cycles is not None and timestamp < last_cycles:
+            wraps += 1
+        last_cycles = timestamp
+        ts = ((wraps << 32) + timestamp) * 1e6 / cpu_hz
+
+        cores.add(core)
+        common = {"pid": core, "tid": thread, "ts": ts}
+
+        if event_type == CONTEXT_SWITCH:
+            if core in running:
+                previous, start = running[core]
+                trace.append({"name": "running", "ph": "X", "pid": core, "tid": previous,
+                              "ts": start, "dur": ts - start})
+            running[core] = (thread, ts)
+            threads.add((core, thread))
+        elif event_type == WAKE:
+            trace.append(dict(common, name="wake from %s" % state_name(arg), ph="i", s="t"))
+            threads.add((core, thread))
+        elif event_type == BLOCK:
+            trace.append(dict(common, name=state_name(arg), ph="i", s="t"))
+            threads.add((core, thread))
+        elif event_type in (IRQ_ENTER, IRQ_EXIT):
+            phase = "B" if event_type == IRQ_ENTER else "E"
+            trace.append(dict(common, tid=IRQ_TRACK_BASE + core, name=exception_name(arg), ph=phase,
+                              args={"thread": thread}))
+        elif event_type == SYSCALL_ENTER:
+            trace.append(dict(common, name="syscall %d" % arg, ph="B"))
+        elif event_type == SYSCALL_EXIT:
+            trace.append(dict(common, ph="E", args={"result": arg}))
+
+    for core in sorted(cores):
+        trace.append({"name": "process_name", "ph": "M", "pid": core, "args": {"name": "CPU %d" % core}})
+        trace.append({"name": "thread_name", "ph": "M", "pid": core, "tid": IRQ_TRACK_BASE + core,
+                      "args": {"name": "interrupts"}})
+    for core, thread in sorted(threads):
+        trace.append({"name": "thread_name", "ph": "M", "pid": core, "tid": thread,
+                      "args": {"name": "thread %d" % thread}})
+
+    return {"traceEvents": trace, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--gdb", metavar="GDB", help="gdb executable to read the buffer from the target with")
+    source.add_argument("--binary", metavar="FILE", help="raw dump of the traceBuffer symbol")
+    source.add_argument("--usart", metavar="FILE", help="console log containing a DumpTrace dump")
+    parser.add_argument("--elf", default="build/startup.elf", help="kernel ELF, used with --gdb")
+    parser.add_argument("--port", type=int, default=63770, help="gdb server port, used with --gdb")
+    parser.add_argument("--cpu-hz", type=int, default=DEFAULT_CPU_HZ, help="core clock, to convert cycles to time")
+    parser.add_argument("-o", "--output", default="-", help="output JSON file, stdout by default")
+    args = parser.parse_args()
+
+    if args.gdb:
+        events = parse_binary(read_with_gdb(args.gdb, args.elf, args.port))
+    elif args.binary:
+        with open(args.binary, "rb") as f:
+            events = parse_binary(f.read())
+    else:
+        with open(args.usart, errors="replace") as f:
+            events = parse_usart(f)
+
+    trace = to_chrome_trace(events, args.cpu_hz)
+    if args.output == "-":
+        json.dump(trace, sys.stdout)
+    else:
+        with open(args.output, "w") as f:
+            json.dump(trace, f)
+
+
+if __name__ == "__main__":
+    main()
@@ -1,14 +1,21 @@
 #include "cpu.h"
 #include "api_request.hpp"
+#include "cpu_accounting.hpp"
+#include "critical_section.h"
+#include "dwt.h"
 #include "kernel_api.hpp"
+#include "proc_mgr.h"
 #include "sys_ctl_block.h"
 #include "thread.h"
+#include "trace.hpp"
+#include <cstddef>
 
 /* SVC Interrupt used for service calls - goes directly to a function that handles requests to make OS calls
  * PendSV used for context switching - from OS back to user process I guess?
  * SysTick used for time slicing - loads the OS thread then chooses which thread to run next
  *
  * PendSV needs to be set to lowest priority in the system - prevents a context switch from occurring during ISR handlers
+ *   -> enforced by the priority plan in interrupt_priorities.cpp
  * Option: SysTick sets the thread scheduler to run next, then sets a pending PendSV request to do the context switch when all other ISRs have finished
  *   -> probably this option
  *
@@ -19,13 +26,24 @@
  *    -> return early if it was and let the SVC call complete
  *       (bonus: complete the call but schedule a new thread to run instead of returning to the caller?)
  * - SVC during PendSV, PendSV during SVC, and SVC during SysTick shouldn't happen
+ *    -> SVC shares the least urgent level with them, so they can't preempt each other. Any other handler can
+ *       preempt a request, requests take the kernel locks (kernel_lock.hpp) around what those handlers touch.
  *
  */
 
 Thread* schedulerThread;
 Thread* volatile runningThread;
-Thread* volatile otherThread; // temp
 SavedRegisters* volatile runningThreadSavedRegisters;
+// Set by SysTick so the scheduler knows to advance the tick before picking a thread.
+static volatile bool tickPending;
+// Cycle count when the running thread was interrupted to enter the scheduler.
+static volatile uint32_t kernelEntryCycles;
+// Set by interrupt handlers that want the running thread preempted, PendSV then enters the scheduler.
+static volatile bool reschedulePending;
+// Set from entering the scheduler until PendSV has switched to the thread it chose.
+static volatile bool inScheduler;
+// Set by the scheduler right before it pends PendSV to switch to the thread it chose.
+static volatile bool switchInPending;
 extern unsigned _INITIAL_STACK_POINTER;
 
 /* Save registers to stack immediately after interrupt - regardless of previous thread.
@@ -74,79 +92,90 @@ SAVE_REGISTERS_AFTER_INTERRUPT(void)
         : "r1", "memory", "cc");
 }
 
-static uint32_t
-GetLastStackValue(void)
-{
-    uint32_t stackPointer;
-    asm volatile(
-        "TST    LR, %[lrStackBit]\n\t"
-        "ITE    EQ\n\t"
-        "MRSEQ  %[sp], MSP\n\t"
-        "MRSNE  %[sp], PSP\n\t"
-        : [sp] "=rm"(stackPointer)
-        : [lrStackBit] "i"(EXCEPTION_LR_PROCESS_STACK)
-        : "cc");
-    return stackPointer;
-}
-
 __attribute__((noreturn)) void
 threadScheduler(void)
 {
-    Thread* temp = runningThread;
-    runningThread = otherThread;
-    otherThread = temp;
-    runningThreadSavedRegisters = const_cast<SavedRegisters*>(runningThread->GetSavedRegisters());
-    SYS_CTL->set_pending_pendsv();
+    {
+        // Interrupt handlers can wake threads, keep them out of the queues while the scheduler uses them.
+        CriticalSection critical;
+        reschedulePending = false;
+        cpuAccounting.ThreadSwitchedOut(0, *runningThread, kernelEntryCycles);
+        if (tickPending)
+        {
+            tickPending = false;
+            processManager.Tick();
+        }
+        Thread* const previous = runningThread;
+        runningThread = processManager.ScheduleNextThread(0);
+        TraceRecord(TraceEventType::ContextSwitch, runningThread->getId(), previous->getId());
+        runningThreadSavedRegisters = const_cast<SavedRegisters*>(runningThread->GetSavedRegisters());
+        switchInPending = true;
+        SYS_CTL->set_pending_pendsv();
+    }
     for (;;) {}
 }
 
-__attribute__((interrupt, noreturn)) void
-PendSV_Handler(void)
+/* Leave the current exception by returning into the running thread, with all of its saved registers.
+    1) Set LR.
+    2) Determine which stack will be used.
+    3) Set SP.
+    4) Set saved registers (R4-R11), last since they may be the ones holding the operands.
+    5) Return from interrupt.
+    - The saved registers may have changed since they were saved, e.g. a request delivering an IPC message.
+    - The registers are only read through R0 so none of the operands end up in R4-R11.
+*/
+__attribute__((always_inline, noreturn)) static inline void
+RESTORE_RUNNING_THREAD(void)
 {
-    // No need to save kernel thread registers - they'll be reset on entry to the kernel anyway.
-    SYS_CTL->clear_pending_pendsv();
-    const auto savedRegs = runningThread->GetSavedRegisters();
-
-    /*
-        1) Set saved registers (R4-R11).
-        2) Set LR.
-        3) Determine which stack will be used.
-        4) Set SP.
-        5) Return from interrupt.
-    */
+    TraceRecord(TraceEventType::IrqExit, runningThread->getId(), TraceGetExceptionNumber());
+    register SavedRegisters* const savedRegs asm("r0") = runningThreadSavedRegisters;
     asm volatile(
-        "LDMDB  %[savedRegsAddr], { R4-R11 }\n\t"
-        "LDR    LR, [%[lr]]\n\t"
+        "LDR    LR, [%[savedRegs], %[lrOffset]]\n\t"
+        "LDR    R1, [%[savedRegs], %[spOffset]]\n\t"
         "TST    LR, %[lrStackBit]\n\t"
         "ITE    EQ\n\t"
-        "MSREQ  MSP, %[sp]\n\t"
-        "MSRNE  PSP, %[sp]\n\t"
+        "MSREQ  MSP, R1\n\t"
+        "MSRNE  PSP, R1\n\t"
+        "LDMIA  %[savedRegs], { R4-R11 }\n\t"
         "BX     LR\n\t"
         :
-        : [savedRegsAddr] "r"(savedRegs->GetLoadMultipleStartAddress()),
-          [sp] "r"(savedRegs->SP),
-          [lr] "r"(&savedRegs->ExceptionLR),
+        : [savedRegs] "r"(savedRegs),
+          [lrOffset] "i"(offsetof(SavedRegisters, ExceptionLR)),
+          [spOffset] "i"(offsetof(SavedRegisters, SP)),
           [lrStackBit] "i"(EXCEPTION_LR_PROCESS_STACK)
-        : "lr", "memory", "cc"); // Are regiser clobbers even necessary here? This function is marked as naked
+        : "r1", "lr", "memory", "cc");
 
     while (true) {}
 }
 
-// These should only be used for SysTick
+/// @brief Restore the running thread and return into it.
+extern "C" __attribute__((interrupt, noreturn)) void
+SwitchToRunningThread(void)
+{
+    // No need to save kernel thread registers - they'll be reset on entry to the kernel anyway.
+    SYS_CTL->clear_pending_pendsv();
+    switchInPending = false;
+    inScheduler = false;
+    cpuAccounting.ThreadSwitchedIn(0, DWT->get_cycle_count());
+    RESTORE_RUNNING_THREAD();
+}
+
+// These should only be used when entering the scheduler
 static volatile uintptr_t stackPointerInt;
 static volatile uintptr_t stackedRegistersStartAddress;
 static volatile AutomaticallyStackedRegisters* volatile stackedRegs;
 static volatile uint32_t linkRegisterValue;
 
-// This is naked because we need to save registers before the compiler uses them.
-// Without this, it's attempting to (push to stack first, then) use R7 which we need to save first.
-__attribute__((interrupt, noreturn, naked)) void
-SysTick_Handler(void)
+/* Leave the current exception by returning into the thread scheduler instead of the interrupted thread.
+    - The running thread's registers must have already been saved.
+    - The scheduler runs in privileged thread mode on a fresh main stack.
+*/
+__attribute__((always_inline, noreturn)) static inline void
+ENTER_SCHEDULER(void)
 {
-    SAVE_REGISTERS_AFTER_INTERRUPT();
-    SYS_CTL->clear_pending_systick();
-
+    TraceRecord(TraceEventType::IrqExit, runningThread->getId(), TraceGetExceptionNumber());
     // Set the registers on the stack to prepare for the scheduler (privileged mode, main stack pointer, PC).
+    inScheduler = true;
     stackPointerInt = reinterpret_cast<uintptr_t>(&_INITIAL_STACK_POINTER);
     // Stack is full-descending, so reduce stack pointer by the size of the registers that should be there. Plus an extra 4 bytes for safety.
     stackedRegistersStartAddress = stackPointerInt - (sizeof(AutomaticallyStackedRegisters) + sizeof(uint32_t));
@@ -169,18 +198,218 @@ SysTick_Handler(void)
     while (true) {}
 }
 
-__attribute__((interrupt)) void
-SVC_Handler(void)
+// This is naked because we need to save registers before the compiler uses them.
+// Without this, it's attempting to (push to stack first, then) use R7 which we need to save first.
+__attribute__((interrupt, noreturn, naked)) void
+SysTick_Handler(void)
+{
+    SAVE_REGISTERS_AFTER_INTERRUPT();
+    kernelEntryCycles = DWT->get_cycle_count();
+    TraceRecord(TraceEventType::IrqEnter, runningThread->getId(), TraceGetExceptionNumber());
+    SYS_CTL->clear_pending_systick();
+    tickPending = true;
+    ENTER_SCHEDULER();
+}
+
+/// @brief Interrupt the running thread to enter the scheduler, on behalf of request_reschedule.
+extern "C" __attribute__((interrupt, noreturn, naked)) void
+PreemptRunningThread(void)
+{
+    SAVE_REGISTERS_AFTER_INTERRUPT();
+    kernelEntryCycles = DWT->get_cycle_count();
+    SYS_CTL->clear_pending_pendsv();
+    ENTER_SCHEDULER();
+}
+
+enum class PendSvAction : uint32_t
+{
+    Ignore,
+    SwitchIn,
+    Preempt,
+};
+
+/// @brief Decide what a PendSV is for. Only uses registers the exception entry already saved.
+extern "C" PendSvAction
+SelectPendSvAction(void)
+{
+    TraceRecord(TraceEventType::IrqEnter, runningThread->getId(), TraceGetExceptionNumber());
+    if (switchInPending) return PendSvAction::SwitchIn;
+    if (inScheduler)
+    {
+        // The scheduler is already running, it will pick from the ready queues once it gets to run again.
+        TraceRecord(TraceEventType::IrqExit, runningThread->getId(), TraceGetExceptionNumber());
+        return PendSvAction::Ignore;
+    }
+    if (reschedulePending) return PendSvAction::Preempt;
+    // The first switch into a thread at start-up.
+    return PendSvAction::SwitchIn;
+}
+
+/* PendSV is pended both by the scheduler, to switch to the thread it chose,
+   and by request_reschedule, to switch away from the running thread.
+    - Naked, so nothing touches R4-R11 or LR before the handler taking over can save them.
+    - Branches instead of calling, so the handler returns straight from the exception.
+*/
+__attribute__((interrupt, noreturn, naked)) void
+PendSV_Handler(void)
+{
+    asm volatile(
+        "PUSH   { R0, LR }\n\t"
+        "BL     SelectPendSvAction\n\t"
+        "MOV    R12, R0\n\t"
+        "POP    { R0, LR }\n\t"
+        "CMP    R12, %[switchIn]\n\t"
+        "BEQ    SwitchToRunningThread\n\t"
+        "CMP    R12, %[preempt]\n\t"
+        "BEQ    PreemptRunningThread\n\t"
+        "BX     LR\n\t"
+        :
+        : [switchIn] "i"(PendSvAction::SwitchIn),
+          [preempt] "i"(PendSvAction::Preempt)
+        : "r12", "memory", "cc");
+}
+
+void
+request_reschedule(void)
+{
+    reschedulePending = true;
+    SYS_CTL->set_pending_pendsv();
+}
+
+void
+device_irq_entered(const uint32_t exceptionNumber)
+{
+    {
+        // Read the cycle count with nested IRQs held off, so they are timed either wholly or not at all.
+        CriticalSection critical;
+        cpuAccounting.IrqEntered(0, DWT->get_cycle_count());
+    }
+    TraceRecord(TraceEventType::IrqEnter, runningThread->getId(), exceptionNumber);
+}
+
+void
+device_irq_exited(const uint32_t exceptionNumber)
+{
+    TraceRecord(TraceEventType::IrqExit, runningThread->getId(), exceptionNumber);
+    CriticalSection critical;
+    cpuAccounting.IrqExited(0, DWT->get_cycle_count());
+}
+
+/// @brief Read a request from the registers stacked by the SVC.
+static os::api::ApiRequest
+DecodeServiceRequest(const AutomaticallyStackedRegisters& stackedRegs)
+{
+    // The return address is just past the SVC instruction, whose immediate is its low byte.
+    const uint32_t svcNumber = *reinterpret_cast<const uint16_t*>(stackedRegs.PC - sizeof(uint16_t)) & SVC_NUMBER_MAX;
+    const uint32_t requestId = (svcNumber == SVC_INDIRECT) ? stackedRegs.R12 : svcNumber;
+    return os::api::ApiRequest{requestId, stackedRegs.R0, stackedRegs.R1, stackedRegs.R2, stackedRegs.R3};
+}
+
+/// @brief Charge the time since kernel entry to the kernel, for a request returning to the thread that made it.
+static void
+ChargeRequestToKernel(Thread& caller, const uint32_t entryCycles)
 {
-    const uint32_t stackPointer = GetLastStackValue();
-    const AutomaticallyStackedRegisters* const stackedRegs = reinterpret_cast<const AutomaticallyStackedRegisters*>(stackPointer);
-    const os::api::ApiRequest apiRequest{stackedRegs->R0, stackedRegs->R1, stackedRegs->R3};
-    os::api::kernelApi.ProcessRequest(apiRequest);
+    cpuAccounting.ThreadSwitchedOut(0, caller, entryCycles);
+    cpuAccounting.ThreadSwitchedIn(0, DWT->get_cycle_count());
+}
+
+/// @brief Carry out a service request from the running thread, whose registers have already been saved.
+/// @return Whether the request stopped the thread from running (e.g. it blocked), so another one must be scheduled.
+static bool
+HandleServiceRequest(void)
+{
+    Thread* const caller = runningThread;
+    AutomaticallyStackedRegisters* const stackedRegs = caller->GetStackedRegisters();
+    const os::api::ApiRequest apiRequest = DecodeServiceRequest(*stackedRegs);
+    TraceRecord(TraceEventType::SyscallEnter, caller->getId(), apiRequest.GetRawId());
+    stackedRegs->R0 = os::api::kernelApi.ProcessRequest(apiRequest);
+    TraceRecord(TraceEventType::SyscallExit, caller->getId(), stackedRegs->R0);
+
+    // Requests can be preempted by interrupt handlers, which can wake threads. Hold them off while switching.
+    CriticalSection critical;
+    Thread* const next = processManager.GetRunningThread(0);
+    if (next != caller)
+    {
+        // The request handed the core straight to another thread (e.g. an IPC call to a waiting server),
+        // return into it without going through the scheduler.
+        cpuAccounting.ThreadSwitchedOut(0, *caller, kernelEntryCycles);
+        TraceRecord(TraceEventType::ContextSwitch, next->getId(), caller->getId());
+        runningThread = next;
+        runningThreadSavedRegisters = const_cast<SavedRegisters*>(next->GetSavedRegisters());
+        cpuAccounting.ThreadSwitchedIn(0, DWT->get_cycle_count());
+        return false;
+    }
+    // The scheduler does the accounting if the caller stopped running.
+    if (caller->getState() != ThreadState::Executing) return true;
+    ChargeRequestToKernel(*caller, kernelEntryCycles);
+    return false;
+}
+
+/// @brief Carry out a request if it is one of the fast ones, which never need the caller's registers saved.
+/// Called from SVCall_Handler as a normal function, so R4-R11 are preserved for the full path.
+/// @param stackedRegs The registers stacked by the SVC.
+/// @return Whether the request was carried out, otherwise it must take the full path.
+extern "C" bool
+TryFastServiceRequest(AutomaticallyStackedRegisters* const stackedRegs)
+{
+    const uint32_t entryCycles = DWT->get_cycle_count();
+    Thread* const caller = runningThread;
+    TraceRecord(TraceEventType::IrqEnter, caller->getId(), TraceGetExceptionNumber());
+    const os::api::ApiRequest apiRequest = DecodeServiceRequest(*stackedRegs);
+    // The full path records the exit.
+    if (!os::api::kernelApi.IsFastRequest(apiRequest.GetId())) return false;
+
+    TraceRecord(TraceEventType::SyscallEnter, caller->getId(), apiRequest.GetRawId());
+    stackedRegs->R0 = os::api::kernelApi.ProcessRequest(apiRequest);
+    TraceRecord(TraceEventType::SyscallExit, caller->getId(), stackedRegs->R0);
+    // The accounting holds off interrupt handlers that preempt the request itself.
+    ChargeRequestToKernel(*caller, entryCycles);
+    TraceRecord(TraceEventType::IrqExit, caller->getId(), TraceGetExceptionNumber());
+    return true;
+}
+
+/// @brief Full path of a request, for requests that may block the caller or switch threads.
+// Naked for the same reason as SysTick: the registers must be saved before the compiler uses them.
+extern "C" __attribute__((interrupt, noreturn, naked)) void
+ServiceRequestFullPath(void)
+{
+    SAVE_REGISTERS_AFTER_INTERRUPT();
+    kernelEntryCycles = DWT->get_cycle_count();
+    if (HandleServiceRequest())
+    {
+        ENTER_SCHEDULER();
+    }
+    RESTORE_RUNNING_THREAD();
+}
+
+/* Requests marked fast in the request table run to completion straight away, like an interrupt handler,
+   returning without saving or restoring the caller's registers. Any other request branches to the full path.
+    - Naked, so nothing touches R4-R11 or LR before the full path can save them.
+    - The stack the SVC stacked the caller's registers on is passed to TryFastServiceRequest.
+*/
+__attribute__((interrupt, noreturn, naked)) void
+SVCall_Handler(void)
+{
+    asm volatile(
+        "TST    LR, %[lrStackBit]\n\t"
+        "ITE    EQ\n\t"
+        "MRSEQ  R0, MSP\n\t"
+        "MRSNE  R0, PSP\n\t"
+        "PUSH   { R0, LR }\n\t"
+        "BL     TryFastServiceRequest\n\t"
+        "POP    { R1, LR }\n\t"
+        "CMP    R0, #0\n\t"
+        "BEQ    ServiceRequestFullPath\n\t"
+        "BX     LR\n\t"
+        :
+        : [lrStackBit] "i"(EXCEPTION_LR_PROCESS_STACK)
+        : "r0", "r1", "r12", "memory", "cc");
 }
 
 void
 cpu_init(void)
 {
+    DWT->enable_cycle_counter();
 }
 
 #if 0
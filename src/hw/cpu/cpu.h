@@ -6,6 +6,15 @@
 
 #define NUM_CPUS 1u
 
+/// @brief Switch away from the running thread once all interrupt handlers have finished, so the scheduler can pick again.
+/// Used by interrupt handlers that woke a thread which should run ahead of the interrupted one.
+void request_reschedule(void);
+
+/// @brief Called by the device IRQ dispatcher (vector_table.h) around the handler of an IRQ that may use the kernel.
+/// @param exceptionNumber The IRQ's exception number, as read from IPSR.
+void device_irq_entered(uint32_t exceptionNumber);
+void device_irq_exited(uint32_t exceptionNumber);
+
 class Cpu
 {
     public:
@@ -0,0 +1,73 @@
+#ifndef _CRITICAL_SECTION_H
+#define _CRITICAL_SECTION_H
+
+#include <cstdint>
+
+/* Kernel critical sections.
+ * Instead of masking every interrupt, a critical section raises BASEPRI to the kernel's interrupt ceiling.
+ * Interrupts at the ceiling or less urgent (priority value >= KERNEL_INTERRUPT_CEILING) wait until it ends.
+ * More urgent interrupts still run straight away, but must never use the kernel, e.g. no *FromIsr calls.
+ * Critical sections nest, each one puts back the BASEPRI it found.
+ * Only privileged code can enter one, BASEPRI writes are ignored in unprivileged thread mode.
+ */
+
+// Most urgent priority an interrupt that uses the kernel can have. Only the implemented priority bits count,
+// the top 4 on the STM32F4. Can be overridden from the top-level Makefile.
+#ifndef KERNEL_INTERRUPT_CEILING
+#define KERNEL_INTERRUPT_CEILING 0x40u
+#endif
+
+static_assert((KERNEL_INTERRUPT_CEILING > 0) && (KERNEL_INTERRUPT_CEILING <= 0xff), "A BASEPRI of 0 masks nothing");
+
+/// @brief Hold off interrupts at or below a ceiling, the kernel's unless given.
+/// @param ceiling Most urgent priority to hold off. Must not be 0, which would unmask everything.
+/// @return The BASEPRI to restore with exit_critical_section.
+__attribute__((always_inline)) inline uint32_t
+enter_critical_section(const uint32_t ceiling = KERNEL_INTERRUPT_CEILING)
+{
+    uint32_t previous;
+    // BASEPRI_MAX only ever raises the mask, so a section entered from a more restrictive one keeps it.
+    asm volatile("MRS    %[previous], BASEPRI\n\t"
+                 "MSR    BASEPRI_MAX, %[ceiling]\n\t"
+                 "DSB\n\t"
+                 "ISB\n\t"
+                 : [previous] "=&r"(previous)
+                 : [ceiling] "r"(ceiling)
+                 : "memory");
+    return previous;
+}
+
+/// @brief Leave a critical section.
+/// @param previous What enter_critical_section returned.
+__attribute__((always_inline)) inline void
+exit_critical_section(const uint32_t previous)
+{
+    asm volatile("MSR    BASEPRI, %[previous]\n\t"
+                 :
+                 : [previous] "r"(previous)
+                 : "memory");
+}
+
+/// @brief Holds a critical section for as long as it is in scope.
+class CriticalSection
+{
+    private:
+        const uint32_t _previousBasePri;
+
+    public:
+        CriticalSection()
+            : _previousBasePri(enter_critical_section())
+        {
+        }
+
+        CriticalSection(const CriticalSection&) = delete;
+        CriticalSection(CriticalSection&&) = delete;
+        ~CriticalSection()
+        {
+            exit_critical_section(_previousBasePri);
+        }
+        CriticalSection& operator=(const CriticalSection&) = delete;
+        CriticalSection& operator=(CriticalSection&&) = delete;
+};
+
+#endif /* _CRITICAL_SECTION_H */
@@ -0,0 +1,20 @@
+#include "dwt.h"
+
+#define DWT_BASE 0xe0001000
+
+// Debug Exception and Monitor Control, part of the debug block rather than the DWT.
+#define DEMCR_ADDR 0xe000edfc
+#define DEMCR_TRCENA (1u << 24)
+
+volatile Dwt* const DWT = reinterpret_cast<volatile Dwt*>(DWT_BASE);
+
+void
+Dwt::enable_cycle_counter(void) volatile
+{
+    /* Trace has to be enabled for any of the DWT to work */
+    volatile uint32_t* const demcr = reinterpret_cast<volatile uint32_t*>(DEMCR_ADDR);
+    *demcr = *demcr | DEMCR_TRCENA;
+
+    CYCCNT = 0;
+    CTRL = CTRL | DWT_CTRL_CYCCNTENA;
+}
@@ -0,0 +1,28 @@
+#ifndef _DWT_H
+#define _DWT_H
+
+#include <cstdint>
+
+#define DWT_CTRL_CYCCNTENA (1u << 0)
+
+// Data Watchpoint and Trace unit. Only the profiling counters are used, for cycle-accurate timestamps.
+class Dwt
+{
+        uint32_t CTRL;     // Control
+        uint32_t CYCCNT;   // Cycle Count
+        uint32_t CPICNT;   // CPI Count
+        uint32_t EXCCNT;   // Exception Overhead Count
+        uint32_t SLEEPCNT; // Sleep Count
+        uint32_t LSUCNT;   // LSU Count
+        uint32_t FOLDCNT;  // Folded-instruction Count
+        uint32_t PCSR;     // Program Counter Sample
+
+    public:
+        uint32_t get_cycle_count(void) const volatile { return CYCCNT; };
+
+        void enable_cycle_counter(void) volatile;
+};
+
+extern volatile Dwt* const DWT;
+
+#endif /* _DWT_H */
@@ -0,0 +1,47 @@
+#ifndef _EXCLUSIVE_ACCESS_H
+#define _EXCLUSIVE_ACCESS_H
+
+#include <cstdint>
+
+/* Exclusive load/store, for atomic read-modify-write without masking interrupts.
+ * Available in unprivileged thread mode. The exclusive monitor is cleared on exception entry and return,
+ * so a store fails if the thread was interrupted since its load - including by the kernel changing the value.
+ */
+
+/// @brief Load a word and mark it for exclusive access (LDREX).
+inline uint32_t
+load_exclusive(volatile uint32_t* const address)
+{
+    uint32_t value;
+    asm volatile("LDREX  %[value], [%[address]]\n\t"
+                 : [value] "=r"(value)
+                 : [address] "r"(address)
+                 : "memory");
+    return value;
+}
+
+/// @brief Store a word if nothing has touched it since the last load_exclusive (STREX).
+/// @return Whether the store happened.
+inline bool
+store_exclusive(volatile uint32_t* const address, const uint32_t value)
+{
+    uint32_t failed;
+    asm volatile("STREX  %[failed], %[value], [%[address]]\n\t"
+                 : [failed] "=&r"(failed)
+                 : [address] "r"(address),
+                   [value] "r"(value)
+                 : "memory");
+    return failed == 0;
+}
+
+/// @brief Give up a load_exclusive without storing (CLREX).
+inline void
+clear_exclusive(void)
+{
+    asm volatile("CLREX\n\t"
+                 :
+                 :
+                 : "memory");
+}
+
+#endif /* _EXCLUSIVE_ACCESS_H */
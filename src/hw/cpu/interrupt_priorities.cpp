@@ -0,0 +1,78 @@
+#include "interrupt_priorities.h"
+
+#define LEAST_URGENT_PREEMPT_PRIORITY (INTERRUPT_PREEMPT_LEVELS - 1u)
+
+/* Drivers add their IRQs here. Interrupts that must never wait for the kernel go above KERNEL_PREEMPT_PRIORITY
+ * and must not use it, everything else goes at or below it.
+ */
+static constexpr InterruptPriority interruptPriorities[] = {
+    // Faults should get reported even from inside other handlers.
+    {SystemException(SystemHandler::MemManage), 0, 0, false},
+    {SystemException(SystemHandler::BusFault), 0, 0, false},
+    {SystemException(SystemHandler::UsageFault), 0, 0, false},
+    // Requests can be preempted by any interrupt handler, they take the kernel locks around what handlers also touch.
+    // Sharing the scheduler's level means a request and a thread switch never interrupt each other, so a thread
+    // woken during a request waits for it to return (see kernel_lock.hpp).
+    {SystemException(SystemHandler::SVCall), KERNEL_REQUEST_PRIORITY, 0, true},
+    // Only ever pends the scheduler.
+    {SystemException(SystemHandler::SysTick), LEAST_URGENT_PREEMPT_PRIORITY, 0, true},
+    // Switches threads, so it must run after every other handler has finished.
+    {SystemException(SystemHandler::PendSV), LEAST_URGENT_PREEMPT_PRIORITY, INTERRUPT_SUBPRIORITY_LEVELS - 1u, true},
+};
+
+static constexpr uint32_t numInterruptPriorities = sizeof(interruptPriorities) / sizeof(interruptPriorities[0]);
+
+static constexpr const InterruptPriority*
+FindInterruptPriority(const uint8_t exception)
+{
+    for (uint32_t i = 0; i < numInterruptPriorities; i++)
+    {
+        if (interruptPriorities[i].Exception == exception) return &interruptPriorities[i];
+    }
+    return nullptr;
+}
+
+static constexpr bool
+IsInterruptPlanValid()
+{
+    const InterruptPriority* const svCall = FindInterruptPriority(SystemException(SystemHandler::SVCall));
+    const InterruptPriority* const pendSv = FindInterruptPriority(SystemException(SystemHandler::PendSV));
+    if ((svCall == nullptr) || (pendSv == nullptr)) return false;
+    if (svCall->PreemptPriority != KERNEL_REQUEST_PRIORITY) return false;
+    if (pendSv->PreemptPriority != LEAST_URGENT_PREEMPT_PRIORITY) return false;
+
+    for (uint32_t i = 0; i < numInterruptPriorities; i++)
+    {
+        const InterruptPriority& entry = interruptPriorities[i];
+        if ((entry.PreemptPriority >= INTERRUPT_PREEMPT_LEVELS) || (entry.SubPriority >= INTERRUPT_SUBPRIORITY_LEVELS)) return false;
+        if (entry.UsesKernel && (entry.PreemptPriority < KERNEL_PREEMPT_PRIORITY)) return false;
+        if ((&entry != pendSv) && (entry.Encode() >= pendSv->Encode())) return false;
+        for (uint32_t j = i + 1; j < numInterruptPriorities; j++)
+        {
+            if (interruptPriorities[j].Exception == entry.Exception) return false;
+        }
+    }
+    return true;
+}
+static_assert(IsInterruptPlanValid(),
+              "Each exception must be listed once, SVCall at the request priority, handlers that use the kernel "
+              "at or below the kernel's ceiling, and PendSV alone at the least urgent priority");
+
+void
+interrupt_priorities_init(void)
+{
+    SYS_CTL->set_priority_grouping(INTERRUPT_PRIGROUP);
+    for (uint32_t i = 0; i < numInterruptPriorities; i++)
+    {
+        const InterruptPriority& entry = interruptPriorities[i];
+        if (entry.Exception < NVIC_FIRST_IRQ_EXCEPTION)
+        {
+            SYS_CTL->set_system_handler_priority(static_cast<SystemHandler>(entry.Exception), entry.Encode());
+        }
+        else
+        {
+            const Nvic::InterruptNumber irq = static_cast<Nvic::InterruptNumber>(entry.Exception - NVIC_FIRST_IRQ_EXCEPTION);
+            NVIC->setPriority(irq, entry.Encode());
+        }
+    }
+}
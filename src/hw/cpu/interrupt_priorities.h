@@ -0,0 +1,65 @@
+#ifndef _INTERRUPT_PRIORITIES_H
+#define _INTERRUPT_PRIORITIES_H
+
+#include "critical_section.h"
+#include "nvic.h"
+#include "sys_ctl_block.h"
+#include <cstdint>
+
+/* Interrupt priority plan.
+ * Every exception with a priority the kernel or a driver cares about is listed once in interruptPriorities
+ * (interrupt_priorities.cpp), which is checked at compile time and applied at boot by interrupt_priorities_init.
+ * Lower numbers are more urgent. An interrupt only preempts another with a more urgent preemption priority,
+ * subpriorities only order pending interrupts of the same preemption priority.
+ */
+
+// Split of the implemented priority bits. Subpriorities take the low bits.
+#define INTERRUPT_SUBPRIORITY_BITS 1u
+#define INTERRUPT_PREEMPT_BITS (NVIC_PRIORITY_BITS - INTERRUPT_SUBPRIORITY_BITS)
+#define INTERRUPT_PREEMPT_LEVELS (1u << INTERRUPT_PREEMPT_BITS)
+#define INTERRUPT_SUBPRIORITY_LEVELS (1u << INTERRUPT_SUBPRIORITY_BITS)
+// AIRCR.PRIGROUP for that split, the bit subpriorities start from counting the unimplemented ones.
+#define INTERRUPT_PRIGROUP ((8u - NVIC_PRIORITY_BITS) + INTERRUPT_SUBPRIORITY_BITS - 1u)
+// BASEPRI only compares preemption priorities, so the kernel's ceiling is one of them.
+#define KERNEL_PREEMPT_PRIORITY (KERNEL_INTERRUPT_CEILING >> (8u - INTERRUPT_PREEMPT_BITS))
+// Requests run at the least urgent preemption priority, with the scheduler, so any interrupt handler can preempt them.
+#define KERNEL_REQUEST_PRIORITY (INTERRUPT_PREEMPT_LEVELS - 1u)
+// BASEPRI that holds off requests and thread switches but no interrupt handler, for state only threads and requests use.
+#define KERNEL_REQUEST_CEILING (KERNEL_REQUEST_PRIORITY << (8u - INTERRUPT_PREEMPT_BITS))
+
+static_assert((KERNEL_INTERRUPT_CEILING & ((1u << (8u - INTERRUPT_PREEMPT_BITS)) - 1u)) == 0,
+              "The kernel's interrupt ceiling must be a preemption priority");
+
+class InterruptPriority
+{
+    public:
+        /// @brief Exception number, as read from IPSR. See SystemException and IrqException.
+        uint8_t Exception;
+        uint8_t PreemptPriority;
+        uint8_t SubPriority;
+        /// @brief Whether the handler uses the kernel, e.g. *FromIsr calls, so it must be at or below the ceiling.
+        bool UsesKernel;
+
+        /// @return The 8-bit priority field to program.
+        constexpr uint8_t Encode() const
+        {
+            return static_cast<uint8_t>(((PreemptPriority << INTERRUPT_SUBPRIORITY_BITS) | SubPriority) << (8u - NVIC_PRIORITY_BITS));
+        }
+};
+
+constexpr uint8_t
+SystemException(const SystemHandler handler)
+{
+    return static_cast<uint8_t>(handler);
+}
+
+constexpr uint8_t
+IrqException(const Nvic::InterruptNumber irq)
+{
+    return static_cast<uint8_t>(NVIC_FIRST_IRQ_EXCEPTION + static_cast<uint8_t>(irq));
+}
+
+/// @brief Set the priority grouping and every priority in the plan. Call before enabling interrupts.
+void interrupt_priorities_init(void);
+
+#endif /* _INTERRUPT_PRIORITIES_H */
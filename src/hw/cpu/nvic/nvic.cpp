@@ -0,0 +1,58 @@
+#include "nvic.h"
+
+#define NVIC_BASE 0xe000e100
+
+#define INTERRUPTS_PER_REG 32u
+#define PRIORITIES_PER_REG 4u
+#define PRIORITY_FIELD_BITS 8u
+#define PRIORITY_FIELD_MASK 0xffu
+
+volatile Nvic* const NVIC = reinterpret_cast<volatile Nvic*>(NVIC_BASE);
+
+void
+Nvic::enableInterrupt(InterruptNumber interruptNum) volatile
+{
+    const uint32_t num = static_cast<uint32_t>(interruptNum);
+    /* Writing 0 bits has no effect, so no need to read first */
+    ISER[num / INTERRUPTS_PER_REG] = 1u << (num % INTERRUPTS_PER_REG);
+}
+
+void
+Nvic::disableInterrupt(InterruptNumber interruptNum) volatile
+{
+    const uint32_t num = static_cast<uint32_t>(interruptNum);
+    ICER[num / INTERRUPTS_PER_REG] = 1u << (num % INTERRUPTS_PER_REG);
+}
+
+void
+Nvic::setPending(InterruptNumber interruptNum) volatile
+{
+    const uint32_t num = static_cast<uint32_t>(interruptNum);
+    ISPR[num / INTERRUPTS_PER_REG] = 1u << (num % INTERRUPTS_PER_REG);
+}
+
+void
+Nvic::clearPending(InterruptNumber interruptNum) volatile
+{
+    const uint32_t num = static_cast<uint32_t>(interruptNum);
+    ICPR[num / INTERRUPTS_PER_REG] = 1u << (num % INTERRUPTS_PER_REG);
+}
+
+void
+Nvic::setPriority(InterruptNumber interruptNum, uint8_t priority) volatile
+{
+    const uint32_t num = static_cast<uint32_t>(interruptNum);
+    const uint32_t shift = (num % PRIORITIES_PER_REG) * PRIORITY_FIELD_BITS;
+    uint32_t ipr = IPR[num / PRIORITIES_PER_REG];
+    ipr &= ~(PRIORITY_FIELD_MASK << shift);
+    ipr |= static_cast<uint32_t>(priority) << shift;
+    IPR[num / PRIORITIES_PER_REG] = ipr;
+}
+
+uint8_t
+Nvic::getPriority(InterruptNumber interruptNum) const volatile
+{
+    const uint32_t num = static_cast<uint32_t>(interruptNum);
+    const uint32_t shift = (num % PRIORITIES_PER_REG) * PRIORITY_FIELD_BITS;
+    return static_cast<uint8_t>((IPR[num / PRIORITIES_PER_REG] >> shift) & PRIORITY_FIELD_MASK);
+}
@@ -3,6 +3,7 @@
 #include "stm32_rcc.h"
 #include "sys_ctl_block.h"
 #include "sys_timer.h"
+#include "vector_table.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -204,6 +205,9 @@ __attribute__((section("ISR_VECTORS"))) FunctionPointer isr_vector_table[] = {
 #endif
 };
 
+const uint32_t isr_vector_table_size = sizeof(isr_vector_table) / sizeof(isr_vector_table[0]);
+static_assert(sizeof(isr_vector_table) / sizeof(isr_vector_table[0]) <= NUM_VECTORS, "The RAM vector table must hold every vector");
+
 __attribute__((noreturn)) void
 abort(void)
 {
@@ -218,6 +222,7 @@ System_Init(void)
      * normal operation here e.g. clocks
      */
     // RCC->init();
+    vector_table_init();
     sys_timer_init();
 }
 
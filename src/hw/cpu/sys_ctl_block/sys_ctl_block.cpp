@@ -2,11 +2,11 @@
 
 #define SYS_CTL_BLOCK_BASE 0xe000e008
 
-#define SHPR3_SYSTICK 0xff000000
-#define SHPR3_SYSTICK_SHIFT 24u
-
-#define SHPR3_PENDSV 0xff0000
-#define SHPR3_PENDSV_SHIFT 16u
+// SHPR1 holds the priority of exception 4, the first configurable one.
+#define SHPR_FIRST_EXCEPTION 4u
+#define SHPR_FIELDS_PER_REG 4u
+#define SHPR_FIELD_BITS 8u
+#define SHPR_FIELD_MASK 0xffu
 
 volatile SysControlBlock* const SYS_CTL = reinterpret_cast<volatile SysControlBlock*>(SYS_CTL_BLOCK_BASE);
 
@@ -28,9 +28,27 @@ SysControlBlock::initialize(void) volatile
     CSR = CSR & ~CSR_CLKSOURCE;
     CSR = CSR | CSR_TICKINT;
 
-    /* Set PendSV priority to a low amount - should be the last interrupt to run */
-    const uint32_t currentSHPR3 = SHPR3;
-    const uint32_t pendSvPriority = (255u << SHPR3_PENDSV_SHIFT) & SHPR3_PENDSV;
-    const uint32_t sysTickPriority = (254u << SHPR3_SYSTICK_SHIFT) & SHPR3_SYSTICK;
-    SHPR3 = currentSHPR3 | pendSvPriority | sysTickPriority;
+    /* Priorities of SysTick, PendSV and SVCall are set with the rest in interrupt_priorities_init */
+}
+
+void
+SysControlBlock::set_priority_grouping(const uint32_t prigroup) volatile
+{
+    /* Writes are ignored without the key */
+    uint32_t aircr = AIRCR;
+    aircr &= ~(AIRCR_VECTKEY_MASK | AIRCR_PRIGROUP);
+    aircr |= AIRCR_VECTKEY | ((prigroup << AIRCR_PRIGROUP_SHIFT) & AIRCR_PRIGROUP);
+    AIRCR = aircr;
+}
+
+void
+SysControlBlock::set_system_handler_priority(const SystemHandler handler, const uint8_t priority) volatile
+{
+    const uint32_t field = static_cast<uint32_t>(handler) - SHPR_FIRST_EXCEPTION;
+    const uint32_t shift = (field % SHPR_FIELDS_PER_REG) * SHPR_FIELD_BITS;
+    volatile uint32_t* const shpr = &SHPR1 + (field / SHPR_FIELDS_PER_REG);
+    uint32_t value = *shpr;
+    value &= ~(SHPR_FIELD_MASK << shift);
+    value |= static_cast<uint32_t>(priority) << shift;
+    *shpr = value;
 }
@@ -3,6 +3,9 @@
 
 #include <cstdint>
 
+// Time between SysTick interrupts, set up in SysControlBlock::initialize.
+#define SYS_TICK_PERIOD_MS 8u
+
 #define CSR_COUNTFLAG (1u << 16)
 #define CSR_CLKSOURCE (1u << 2)
 #define CSR_TICKINT (1u << 1)
@@ -21,6 +24,25 @@
 #define ICSR_PENDSTSET (1u << 26)
 #define ICSR_PENDSTCLR (1u << 25)
 
+#define VTOR_TBLOFF 0xffffff80
+
+#define AIRCR_VECTKEY (0x05fau << 16)
+#define AIRCR_VECTKEY_MASK 0xffff0000
+#define AIRCR_PRIGROUP 0x700
+#define AIRCR_PRIGROUP_SHIFT 8u
+
+// Exception numbers of the core's handlers that have a configurable priority.
+enum class SystemHandler : uint8_t
+{
+    MemManage = 4,
+    BusFault = 5,
+    UsageFault = 6,
+    SVCall = 11,
+    DebugMonitor = 12,
+    PendSV = 14,
+    SysTick = 15,
+};
+
 class SysControlBlock
 {
         uint32_t ACTLR; // Auxiliary Control
@@ -60,6 +82,14 @@ class SysControlBlock
         void set_pending_systick(void) volatile { ICSR = ICSR | ICSR_PENDSTSET; };
         void clear_pending_systick(void) volatile { ICSR = ICSR | ICSR_PENDSTCLR; };
 
+        /* PRIGROUP is the bit of each priority field that subpriorities start from,
+         * the bits above it are the preemption priority. */
+        void set_priority_grouping(const uint32_t prigroup) volatile;
+        /* Address must be aligned to the table size rounded up to a power of 2 */
+        void set_vector_table(const uintptr_t address) volatile { VTOR = address & VTOR_TBLOFF; };
+        /* Priority is the full 8-bit field, only the chip's implemented bits are kept. */
+        void set_system_handler_priority(const SystemHandler handler, const uint8_t priority) volatile;
+
         void initialize(void) volatile;
 };
 
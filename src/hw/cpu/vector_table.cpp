@@ -0,0 +1,67 @@
+#include "vector_table.h"
+#include "cpu.h"
+#include "critical_section.h"
+#include "sys_ctl_block.h"
+
+alignas(VECTOR_TABLE_ALIGNMENT) static IrqHandler volatile ramVectorTable[NUM_VECTORS];
+// The handler the dispatcher calls for each device IRQ.
+static IrqHandler volatile deviceIrqHandlers[static_cast<uint32_t>(Nvic::InterruptNumber::NUM_IRQS)];
+
+/// @brief Vector of every device IRQ. Calls its handler, telling the kernel when the handler starts and ends.
+static void
+DispatchDeviceIrq(void)
+{
+    uint32_t exceptionNumber;
+    asm volatile("MRS    %[ipsr], IPSR\n\t"
+                 : [ipsr] "=r"(exceptionNumber));
+    const Nvic::InterruptNumber irq = static_cast<Nvic::InterruptNumber>(exceptionNumber - NVIC_FIRST_IRQ_EXCEPTION);
+    // IRQs more urgent than the ceiling can preempt a critical section, so they must not touch the kernel at all.
+    const bool withKernel = NVIC->getPriority(irq) >= KERNEL_INTERRUPT_CEILING;
+
+    if (withKernel) device_irq_entered(exceptionNumber);
+    deviceIrqHandlers[static_cast<uint32_t>(irq)]();
+    if (withKernel) device_irq_exited(exceptionNumber);
+}
+
+void
+vector_table_init(void)
+{
+    for (uint32_t i = 0; i < isr_vector_table_size; i++)
+    {
+        if (i < NVIC_FIRST_IRQ_EXCEPTION)
+        {
+            ramVectorTable[i] = isr_vector_table[i];
+        }
+        else
+        {
+            deviceIrqHandlers[i - NVIC_FIRST_IRQ_EXCEPTION] = isr_vector_table[i];
+            ramVectorTable[i] = DispatchDeviceIrq;
+        }
+    }
+
+    /* The table must be written before the core can fetch from it */
+    asm volatile("DSB\n\t"
+                 :
+                 :
+                 : "memory");
+    SYS_CTL->set_vector_table(reinterpret_cast<uintptr_t>(ramVectorTable));
+    asm volatile("DSB\n\t"
+                 "ISB\n\t"
+                 :
+                 :
+                 : "memory");
+}
+
+IrqHandler
+register_irq_handler(const Nvic::InterruptNumber irq, const IrqHandler handler)
+{
+    const IrqHandler previous = deviceIrqHandlers[static_cast<uint32_t>(irq)];
+    deviceIrqHandlers[static_cast<uint32_t>(irq)] = handler;
+    ramVectorTable[NVIC_FIRST_IRQ_EXCEPTION + static_cast<uint32_t>(irq)] = DispatchDeviceIrq;
+    /* Make sure an interrupt taken straight after this calls the new handler */
+    asm volatile("DSB\n\t"
+                 :
+                 :
+                 : "memory");
+    return previous;
+}
@@ -0,0 +1,35 @@
+#ifndef _VECTOR_TABLE_H
+#define _VECTOR_TABLE_H
+
+#include "nvic.h"
+#include <cstdint>
+
+/* The vector table the core uses, a copy of isr_vector_table in SRAM.
+ * Vector fetches then skip the flash wait states, and drivers can install their IRQ handlers at run time
+ * instead of overriding the weak ones in startup.h.
+ * Every device IRQ vectors to a dispatcher, which calls the installed handler between device_irq_entered and
+ * device_irq_exited (cpu.h) unless the IRQ is more urgent than the kernel ceiling.
+ */
+
+// Core exceptions followed by every device IRQ.
+#define NUM_VECTORS (NVIC_FIRST_IRQ_EXCEPTION + static_cast<uint32_t>(Nvic::InterruptNumber::NUM_IRQS))
+// VTOR needs the table aligned to its size rounded up to a power of 2.
+#define VECTOR_TABLE_ALIGNMENT 512u
+
+static_assert(NUM_VECTORS * sizeof(uint32_t) <= VECTOR_TABLE_ALIGNMENT, "The vector table must fit its alignment");
+
+typedef void (*IrqHandler)(void);
+
+/* Defined in startup.cpp */
+extern IrqHandler isr_vector_table[];
+extern const uint32_t isr_vector_table_size;
+
+/// @brief Copy the flash vector table to SRAM and point VTOR at it. Call before enabling any interrupts.
+void vector_table_init(void);
+
+/// @brief Install the handler for a device IRQ. Takes effect for the next time the IRQ is taken.
+/// Handlers are normal functions, the dispatcher takes the exception.
+/// @return The handler it replaces.
+IrqHandler register_irq_handler(const Nvic::InterruptNumber irq, const IrqHandler handler);
+
+#endif /* _VECTOR_TABLE_H */
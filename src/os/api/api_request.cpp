@@ -2,9 +2,8 @@
 
 using namespace os::api;
 
-ApiRequest::ApiRequest(const uint32_t param0, const uint32_t param1, const uint32_t param2)
-    : _param0(param0),
-      _param1(param1),
-      _param2(param2)
+ApiRequest::ApiRequest(const uint32_t id, const uint32_t param1, const uint32_t param2, const uint32_t param3, const uint32_t param4)
+    : _id(id),
+      _params{param1, param2, param3, param4}
 {
 }
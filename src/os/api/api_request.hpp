@@ -1,23 +1,74 @@
 #ifndef _API_REQUEST_H
 #define _API_REQUEST_H
 
+#include "api_request_list.hpp"
 #include <cstdint>
+#include <type_traits>
+
+// Largest request ID an SVC instruction can encode in its immediate.
+#define SVC_NUMBER_MAX 255u
+// SVC immediate for requests whose ID is only known at run time, the ID is passed in R12 instead.
+#define SVC_INDIRECT 0u
+// One parameter per argument register, R0-R3.
+#define API_REQUEST_MAX_PARAMS 4u
 
 namespace os::api
 {
+    /// @brief Identifies the kernel service being requested, passed as the SVC immediate. Generated from API_REQUEST_LIST.
+    enum class ApiRequestId : uint32_t
+    {
+        None,
+#define API_REQUEST_ID(name, result, params, batchable, fast, async) name,
+        API_REQUEST_LIST(API_REQUEST_ID, API_REQUEST_ID)
+#undef API_REQUEST_ID
+        NUM_REQUESTS,
+    };
+
+    namespace details
+    {
+        /// @brief Convert a parameter register to the type a request takes.
+        template <typename T>
+        T FromRegister(const uint32_t value)
+        {
+            if constexpr (std::is_pointer_v<T>)
+            {
+                return reinterpret_cast<T>(value);
+            }
+            else
+            {
+                return static_cast<T>(value);
+            }
+        }
+
+        /// @brief Convert a request's parameter or result to a register.
+        template <typename T>
+        uint32_t ToRegister(const T value)
+        {
+            if constexpr (std::is_pointer_v<T>)
+            {
+                return reinterpret_cast<uintptr_t>(value);
+            }
+            else
+            {
+                return static_cast<uint32_t>(value);
+            }
+        }
+    }
+
     class ApiRequest
     {
         private:
-            const uint32_t _param0;
-            const uint32_t _param1;
-            const uint32_t _param2;
+            const uint32_t _id;
+            const uint32_t _params[API_REQUEST_MAX_PARAMS];
 
         public:
-            ApiRequest(const uint32_t param0, const uint32_t param1, const uint32_t param2);
+            /// @param id The request ID, not checked against ApiRequestId::NUM_REQUESTS yet.
+            ApiRequest(const uint32_t id, const uint32_t param1, const uint32_t param2, const uint32_t param3, const uint32_t param4);
 
-            uint32_t GetParam0() const { return _param0; };
-            uint32_t GetParam1() const { return _param1; };
-            uint32_t GetParam2() const { return _param2; };
+            ApiRequestId GetId() const { return static_cast<ApiRequestId>(_id); };
+            uint32_t GetRawId() const { return _id; };
+            /// @param index 0 for param 1, and so on.
+            uint32_t GetParam(const uint32_t index) const { return _params[index]; };
     };
 }
 
@@ -0,0 +1,108 @@
+#ifndef _API_REQUEST_LIST_H
+#define _API_REQUEST_LIST_H
+
+/* Every kernel request, in ApiRequestId order. This is the only place a request is described,
+ * the ApiRequestId values, the kernel's request table and the libos stubs are all generated from it.
+ *
+ * REQUEST(Name, Result, (Params...), Batchable, Fast, Async)
+ *     Name       ApiRequestId value. The kernel handler is HandleName(Thread& caller, Params...).
+ *     Result     What the request returns in R0.
+ *     Params     Passed in R0-R3, at most API_REQUEST_MAX_PARAMS of them.
+ *     Batchable  Can be taken from a SyscallRing, i.e. never blocks the caller.
+ *     Fast       Runs straight from the SVC handler, see KernelApi::IsFastRequest.
+ *     Async      Can be made through SubmitAsync, see AsyncManager. Must be batchable, and must take the kernel's
+ *                critical section around anything the scheduler or interrupt handlers also touch.
+ * MESSAGE_REQUEST(...) is the same, for requests that also pass a message in R4-R11. They have no libos stub,
+ * threads make them through os::ipc::IpcRequest.
+ *
+ * Types must be named the same from any namespace.
+ */
+#define API_REQUEST_LIST(REQUEST, MESSAGE_REQUEST)                                                                      \
+    /* Copy per-thread CPU usage to a CpuUsageEntry array. Returns the number of entries written. */                    \
+    REQUEST(GetCpuUsage, uint32_t, (CpuUsageEntry*, uint32_t), true, false, false)                                      \
+    /* Write a table of per-thread CPU usage to the console USART. */                                                   \
+    REQUEST(PrintCpuUsage, void, (), true, false, true)                                                                 \
+    /* Move the caller into the deadline scheduling class. */                                                          \
+    REQUEST(SetDeadlineParameters, KernelResultStatus, (const DeadlineParameters*), false, false, false)                \
+    /* Process ID, budget and period in ms. Limits the CPU time of the process's threads, a budget of 0 lifts it.      \
+     * Error unless the caller's process is the target's parent or the kernel's. */                                    \
+    REQUEST(SetCpuQuota, KernelResultStatus, (uint32_t, uint32_t, uint32_t), true, false, false)                        \
+    /* Complete the caller's current deadline job and block until the next one is released. */                         \
+    REQUEST(WaitForNextPeriod, void, (), false, false, false)                                                           \
+    /* Get the number of deadlines the caller has missed. */                                                           \
+    REQUEST(GetDeadlineMisses, uint32_t, (), true, true, false)                                                         \
+    /* Write the scheduler event trace to the console USART. Error if tracing isn't compiled in. */                    \
+    REQUEST(DumpTrace, KernelResultStatus, (), true, false, true)                                                       \
+    /* Get the caller's thread ID. */                                                                                  \
+    REQUEST(GetThreadId, uint32_t, (), true, true, false)                                                               \
+    /* Slow path of Mutex::Lock, for a mutex held by another thread. Takes the mutex's lock word. */                   \
+    REQUEST(LockMutex, KernelResultStatus, (volatile uint32_t*), false, false, false)                                   \
+    /* Slow path of Mutex::Unlock, for a mutex with waiters. Takes the mutex's lock word. */                           \
+    REQUEST(UnlockMutex, KernelResultStatus, (volatile uint32_t*), true, false, false)                                  \
+    /* Semaphore handle, timeout in ticks. Handles need Wait to wait on an object and Signal for anything else. */     \
+    REQUEST(SemaphoreWait, KernelResultStatus, (Handle, uint32_t), false, false, false)                                 \
+    REQUEST(SemaphorePost, KernelResultStatus, (Handle), true, true, false)                                             \
+    /* EventFlags handle, flags to wait for, EVENT_FLAGS_* options, timeout in ticks. Returns the flags that ended     \
+     * the wait, 0 on timeout. */                                                                                       \
+    REQUEST(EventFlagsWait, uint32_t, (Handle, uint32_t, uint32_t, uint32_t), false, false, false)                      \
+    REQUEST(EventFlagsSet, KernelResultStatus, (Handle, uint32_t), true, true, false)                                   \
+    REQUEST(EventFlagsClear, KernelResultStatus, (Handle, uint32_t), true, true, false)                                 \
+    /* ConditionVariable handle, lock word of the mutex to release, timeout in ticks. */                               \
+    REQUEST(ConditionWait, KernelResultStatus, (Handle, volatile uint32_t*, uint32_t), false, false, false)             \
+    REQUEST(ConditionNotifyOne, KernelResultStatus, (Handle), true, true, false)                                        \
+    REQUEST(ConditionNotifyAll, KernelResultStatus, (Handle), true, true, false)                                        \
+    /* Thread ID, NotifyAction, value. Error if there is no such thread. */                                            \
+    REQUEST(NotifyThread, KernelResultStatus, (uint32_t, NotifyAction, uint32_t), true, true, false)                    \
+    /* Bits to clear once taken, timeout in ticks. Returns the notification value, 0 on timeout. */                    \
+    REQUEST(WaitForNotification, uint32_t, (uint32_t, uint32_t), false, false, false)                                   \
+    /* Send the message. Receiving thread ID, timeout in ticks. */                                                     \
+    MESSAGE_REQUEST(IpcSend, KernelResultStatus, (uint32_t, uint32_t), false, false, false)                             \
+    /* Send the message and wait for the reply in its place. Params as IpcSend. */                                     \
+    MESSAGE_REQUEST(IpcCall, KernelResultStatus, (uint32_t, uint32_t), false, false, false)                             \
+    /* Receive a message. Sending thread ID or IPC_ANY_THREAD, timeout in ticks. Returns the sender's thread ID,       \
+     * 0 on timeout. */                                                                                                 \
+    MESSAGE_REQUEST(IpcReceive, uint32_t, (uint32_t, uint32_t), false, false, false)                                    \
+    /* Reply with the message. Calling thread ID. Not batchable, the message is in the caller's registers. */          \
+    MESSAGE_REQUEST(IpcReply, KernelResultStatus, (uint32_t), false, false, false)                                      \
+    /* IpcReply, then IpcReceive from any thread. Calling thread ID, timeout in ticks. Returns the next sender's       \
+     * thread ID, 0 on timeout. */                                                                                      \
+    MESSAGE_REQUEST(IpcReplyWait, uint32_t, (uint32_t, uint32_t), false, false, false)                                  \
+    /* RegionQueue handle, start of one of the caller's memory regions, timeout in ticks. */                           \
+    REQUEST(RegionQueueSend, KernelResultStatus, (Handle, uintptr_t, uint32_t), false, false, false)                    \
+    /* RegionQueue handle, timeout in ticks. Returns the start of the region received, 0 on timeout. */                \
+    REQUEST(RegionQueueReceive, uintptr_t, (Handle, uint32_t), false, false, false)                                     \
+    /* Start of one of the caller's memory regions. Returns its size, 0 if the caller doesn't own it. */               \
+    REQUEST(GetMemRegionSize, size_t, (uintptr_t), true, true, false)                                                   \
+    /* Key, size to create it with, MemPermisions. Returns the start of the shared memory, 0 if it can't be            \
+     * attached. */                                                                                                     \
+    REQUEST(SharedMemoryAttach, uintptr_t, (uint32_t, size_t, MemPermisions), false, false, false)                      \
+    /* Start of the shared memory. */                                                                                  \
+    REQUEST(SharedMemoryDetach, KernelResultStatus, (uintptr_t), false, false, false)                                   \
+    /* SyscallRing for the caller's process. */                                                                        \
+    REQUEST(RegisterSyscallRing, KernelResultStatus, (os::api::SyscallRing*), false, false, false)                      \
+    /* Carry out the requests queued in the caller's process's SyscallRing. Returns the number carried out. */         \
+    REQUEST(SubmitSyscalls, uint32_t, (), false, false, false)                                                          \
+    /* Get the number of ticks since the scheduler started. */                                                         \
+    REQUEST(GetTickCount, uint32_t, (), true, true, false)                                                              \
+    /* Give up the rest of the caller's time slice. */                                                                 \
+    REQUEST(Yield, void, (), true, true, false)                                                                         \
+    /* Start an async request and return straight away. Returns its ticket, 0 if it can't be started. */              \
+    REQUEST(SubmitAsync, uint32_t, (os::api::AsyncRequest*), true, false, false)                                        \
+    /* Initial count, maximum count. Returns a handle with every right to a new semaphore, HANDLE_NONE if it           \
+     * can't be made. A kernel object is destroyed once every handle to it is closed, waking its waiters. */            \
+    REQUEST(CreateSemaphore, Handle, (uint32_t, uint32_t), true, false, false)                                          \
+    /* Returns a handle with every right to new EventFlags, all clear. HANDLE_NONE if it can't be made. */             \
+    REQUEST(CreateEventFlags, Handle, (), true, false, false)                                                           \
+    /* Returns a handle with every right to a new condition variable, HANDLE_NONE if it can't be made. */              \
+    REQUEST(CreateConditionVariable, Handle, (), true, false, false)                                                    \
+    /* Depth, at most REGION_QUEUE_MAX_DEPTH. Returns a handle with every right to a new region queue,                 \
+     * HANDLE_NONE if it can't be made. */                                                                              \
+    REQUEST(CreateRegionQueue, Handle, (uint32_t), true, false, false)                                                  \
+    /* Give up one of the caller's process's handles, destroying the object if it was the last handle to it.           \
+     * Error if it is stale. */                                                                                         \
+    REQUEST(CloseHandle, KernelResultStatus, (Handle), true, false, false)                                              \
+    /* Handle with Duplicate, ID of the process to give it to, HandleRights for the new handle, at most the            \
+     * original's. Returns the new handle, HANDLE_NONE if it can't be made. */                                          \
+    REQUEST(DuplicateHandle, Handle, (Handle, uint32_t, HandleRights), true, false, false)
+
+#endif /* _API_REQUEST_LIST_H */
@@ -0,0 +1,139 @@
+#include "async_manager.hpp"
+#include "kernel_api.hpp"
+#include "kernel_lock.hpp"
+#include "libos.hpp"
+#include "proc_mgr.h"
+
+// Wakes the async worker. Any bit will do, it takes them all.
+#define ASYNC_NOTIFY_BIT 1u
+
+namespace os::api
+{
+    AsyncManager asyncManager;
+
+    AsyncManager::AsyncManager()
+        : _operations(),
+          _nextTicket(1),
+          _pending(),
+          _procMgr(nullptr),
+          _workerThread()
+    {
+    }
+
+    AsyncManager::~AsyncManager()
+    {
+        // Intentionally do nothing.
+    }
+
+    void
+    AsyncManager::Initialize(ProcessManager& procMgr, MemoryManager& memMgr)
+    {
+        _procMgr = &procMgr;
+        _workerThread = Thread{*_procMgr->GetKernelProcess(), memMgr, WorkerThreadEntry};
+        _procMgr->RegisterThread(_workerThread);
+        // Handlers are kernel code and may touch the hardware directly.
+        _workerThread.SetThreadMode(true, true);
+        _procMgr->SetThreadPriority(_workerThread, THREAD_PRIORITY_LOWEST);
+        _procMgr->ReadyThread(_workerThread, false);
+    }
+
+    void
+    AsyncManager::WorkerThreadEntry()
+    {
+        while (true)
+        {
+            WorkFunction function = nullptr;
+            uintptr_t argument = 0;
+            if (asyncManager._pending.Pop(function, argument))
+            {
+                function(argument);
+                continue;
+            }
+            // Anything submitted since the queue was found empty has already set the notification.
+            os::libos::WaitForNotification(0xffffffffu, WAIT_FOREVER);
+        }
+    }
+
+    uint32_t
+    AsyncManager::Submit(Thread& caller, AsyncRequest& request)
+    {
+        if (!kernelApi.IsAsyncRequest(request.Id) || (request.Signal >= AsyncSignal::NUM_SIGNALS)) return 0;
+        // Resolved now, while it is the caller's process's handle that is being used.
+        EventFlags* flags = nullptr;
+        if (request.Signal == AsyncSignal::EventFlags)
+        {
+            flags = caller.getProcess().GetHandles().Resolve<EventFlags>(request.Flags, HandleRights::Signal);
+            if (flags == nullptr) return 0;
+        }
+
+        // Requests can't be preempted by the async worker, which frees the slots, so claiming one needs no lock.
+        uint32_t index = 0;
+        while ((index < ASYNC_MAX_IN_FLIGHT) && (_operations[index].Request != nullptr))
+        {
+            index++;
+        }
+        if (index == ASYNC_MAX_IN_FLIGHT) return 0;
+
+        // 0 means the request wasn't started, so skip it when the tickets wrap.
+        const uint32_t ticket = _nextTicket;
+        _nextTicket = (ticket == UINT32_MAX) ? 1 : (ticket + 1);
+
+        request.Done = false;
+        _operations[index] = Operation{&request, &caller, flags, ticket, request.Signal, request.ThreadId, request.SignalValue};
+        if (!_pending.Push(RunOperation, index))
+        {
+            _operations[index].Request = nullptr;
+            return 0;
+        }
+        if (flags != nullptr)
+        {
+            // Closing the handle meanwhile must not destroy the flags before they are set.
+            KernelLock::Guard guard(processLock);
+            HandleTable::Retain(*flags);
+        }
+        _procMgr->NotifyThreadFromIsr(_workerThread, NotifyAction::SetBits, ASYNC_NOTIFY_BIT);
+        return ticket;
+    }
+
+    void
+    AsyncManager::RunOperation(const uintptr_t index)
+    {
+        Operation& operation = asyncManager._operations[index];
+        const AsyncRequest& request = *operation.Request;
+        const ApiRequest apiRequest{static_cast<uint32_t>(request.Id), request.Params[0], request.Params[1], request.Params[2], request.Params[3]};
+        // Runs preemptibly, async handlers take the kernel's critical section themselves where they need it.
+        const uint32_t result = kernelApi.ProcessRequest(*operation.Caller, apiRequest);
+        asyncManager.Complete(operation, result);
+    }
+
+    void
+    AsyncManager::Complete(Operation& operation, const uint32_t result)
+    {
+        // The signal is sent from the copy in the operation, the request can be reused as soon as Done is set.
+        AsyncRequest& request = *operation.Request;
+        request.Result = result;
+        request.Done = true;
+
+        switch (operation.Signal)
+        {
+            case AsyncSignal::EventFlags:
+            {
+                operation.Flags->SetFromIsr(operation.SignalValue);
+                KernelLock::Guard guard(processLock);
+                HandleTable::Release(*operation.Flags);
+                break;
+            }
+            case AsyncSignal::Notification:
+            {
+                Thread* const thread = (operation.ThreadId == 0) ? operation.Caller : processManager.FindThread(operation.ThreadId);
+                if (thread != nullptr) processManager.NotifyThreadFromIsr(*thread, NotifyAction::SetBits, operation.SignalValue);
+                break;
+            }
+            default:
+                break;
+        }
+
+        // The slot can be reused once it is released. A single store, so a request submitted meanwhile sees it or not.
+        operation.Request = nullptr;
+    }
+}
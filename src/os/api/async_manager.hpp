@@ -0,0 +1,71 @@
+#ifndef _ASYNC_MANAGER_H
+#define _ASYNC_MANAGER_H
+
+#include "async_request.hpp"
+#include "event_flags.hpp"
+#include "thread.h"
+#include "work_queue.hpp"
+#include <cstdint>
+
+class MemoryManager;
+class ProcessManager;
+
+// Async requests that can be in flight at once, across every thread.
+#define ASYNC_MAX_IN_FLIGHT 8u
+
+namespace os::api
+{
+    /* Carries out AsyncRequests on a kernel thread of its own, at THREAD_PRIORITY_LOWEST.
+     * Async requests are the slow ones, e.g. console output that busy-waits on the USART, so they only run when
+     * no other thread is ready. Deferred interrupt work keeps the WorkQueue worker to itself.
+     */
+    class AsyncManager
+    {
+        private:
+            class Operation
+            {
+                public:
+                    /// @brief nullptr while the slot is free.
+                    AsyncRequest* Request;
+                    Thread* Caller;
+                    /// @brief What the request's Flags handle named when it was submitted, for AsyncSignal::EventFlags.
+                    EventFlags* Flags;
+                    uint32_t Ticket;
+                    /// @brief Copied from the request when it was submitted. The request isn't read once Done is set,
+                    /// since its thread can reuse it from then on.
+                    AsyncSignal Signal;
+                    uint32_t ThreadId;
+                    uint32_t SignalValue;
+            };
+
+            Operation _operations[ASYNC_MAX_IN_FLIGHT];
+            uint32_t _nextTicket;
+            /// @brief Operations submitted and not yet started, by slot index. The async worker is its only consumer.
+            WorkRing _pending;
+            ProcessManager* _procMgr;
+            Thread _workerThread;
+
+            static void WorkerThreadEntry();
+            static void RunOperation(uintptr_t index);
+            void Complete(Operation& operation, const uint32_t result);
+
+        public:
+            AsyncManager();
+            AsyncManager(const AsyncManager&) = delete;
+            AsyncManager(AsyncManager&&) = delete;
+            ~AsyncManager();
+            AsyncManager& operator=(const AsyncManager&) = delete;
+            AsyncManager& operator=(AsyncManager&&) = delete;
+
+            /// @brief Create the async worker in the kernel process and make it ready. Call after the process manager is set up.
+            void Initialize(ProcessManager& procMgr, MemoryManager& memMgr);
+
+            /// @brief Queue an async request for the async worker. Only called from requests.
+            /// @return The request's ticket, 0 if it can't be made asynchronously or there is no room for it.
+            uint32_t Submit(Thread& caller, AsyncRequest& request);
+    };
+
+    extern AsyncManager asyncManager;
+}
+
+#endif /* _ASYNC_MANAGER_H */
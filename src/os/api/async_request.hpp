@@ -0,0 +1,55 @@
+#ifndef _ASYNC_REQUEST_H
+#define _ASYNC_REQUEST_H
+
+#include "api_request.hpp"
+#include "libos.hpp"
+#include <cstdint>
+
+namespace os::api
+{
+    /// @brief How the kernel tells the thread that an async request has completed.
+    enum class AsyncSignal : uint8_t
+    {
+        /// @brief Nothing, the thread checks Done.
+        None,
+        /// @brief Set SignalValue in an EventFlags.
+        EventFlags,
+        /// @brief Set SignalValue's bits in a thread's notification value.
+        Notification,
+        NUM_SIGNALS,
+    };
+
+    /* A request carried out by the kernel's async worker thread while the thread that made it carries on,
+     * so one thread can have several slow requests (e.g. console output) in flight at once.
+     * Only requests marked Async in API_REQUEST_LIST can be made this way.
+     * Lives in the caller's memory. It must stay there, untouched, from SubmitAsync until Done is set.
+     */
+    class AsyncRequest
+    {
+        public:
+            ApiRequestId Id;
+            uint32_t Params[API_REQUEST_MAX_PARAMS];
+            AsyncSignal Signal;
+            /// @brief Handle with Signal to the flags to set, for AsyncSignal::EventFlags.
+            Handle Flags;
+            /// @brief The thread to notify, for AsyncSignal::Notification. 0 for the thread that made the request.
+            uint32_t ThreadId;
+            /// @brief Flags or notification bits to set once the request has completed.
+            uint32_t SignalValue;
+            /// @brief Written by the kernel. Result is only valid once Done is set, which happens before the signal.
+            /// Done is the kernel's last write, the request can be reused or freed once it is set.
+            volatile uint32_t Result;
+            volatile bool Done;
+    };
+
+    /// @brief Start an async request. Everything up to SignalValue must be filled in.
+    /// @return The request's ticket, 0 if it can't be made asynchronously or too many are in flight.
+    ///         Nothing is signalled for a request that wasn't started.
+    inline uint32_t
+    SubmitAsync(AsyncRequest& request)
+    {
+        return os::libos::SubmitAsync(&request);
+    }
+}
+
+#endif /* _ASYNC_REQUEST_H */
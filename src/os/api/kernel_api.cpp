@@ -1,5 +1,18 @@
 #include "kernel_api.hpp"
+#include "async_manager.hpp"
+#include "condition_variable.hpp"
+#include "cpu_accounting.hpp"
+#include "event_flags.hpp"
+#include "ipc.hpp"
+#include "kernel_lock.hpp"
+#include "mutex_mgr.hpp"
 #include "proc_mgr.h"
+#include "region_queue.hpp"
+#include "request_handler.hpp"
+#include "semaphore.hpp"
+#include "shared_memory.hpp"
+#include "syscall_ring.hpp"
+#include "trace.hpp"
 
 static void
 ApiEntryFunction()
@@ -14,13 +27,466 @@ namespace os::api
 {
     KernelApi kernelApi;
 
+    static bool IsBatchable(const ApiRequestId id);
+
+    /// @brief Carry out the requests queued in a ring, as far as there is room for their completions.
+    /// @return The number of requests carried out.
+    static uint32_t
+    ProcessSyscallRing(SyscallRing& ring, const Thread& caller)
+    {
+        uint32_t processed = 0;
+        while ((ring.SubmitTail != ring.SubmitHead) && ((ring.CompleteHead - ring.CompleteTail) < SYSCALL_RING_ENTRIES))
+        {
+            // Stop once a request has made the caller yield, the rest wait for the next submit.
+            if (caller.getState() != ThreadState::Executing) break;
+
+            const uint32_t tail = ring.SubmitTail;
+            const SyscallSubmission submission = ring.Submissions[tail & (SYSCALL_RING_ENTRIES - 1)];
+            ring.SubmitTail = tail + 1;
+
+            const ApiRequest request{static_cast<uint32_t>(submission.Id), submission.Params[0], submission.Params[1],
+                                     submission.Params[2], submission.Params[3]};
+            const uint32_t result = IsBatchable(submission.Id)
+                                        ? kernelApi.ProcessRequest(request)
+                                        : static_cast<uint32_t>(KernelResultStatus::Error);
+            const uint32_t head = ring.CompleteHead;
+            ring.Completions[head & (SYSCALL_RING_ENTRIES - 1)] = SyscallCompletion{submission.UserData, result};
+            ring.CompleteHead = head + 1;
+            processed++;
+        }
+        return processed;
+    }
+
+    /* Request handlers, declared with the types they take. RequestAdapter converts the argument registers.
+     * All of them act for the thread running on core 0.
+     * Fast requests run straight from the SVC handler, so they wake threads the way interrupt handlers do.
+     * Interrupt handlers can preempt any request. Each handler takes the lock of the subsystem whose state it
+     * changes, see kernel_lock.hpp. Objects that interrupt handlers also signal need schedulerLock throughout,
+     * so a wakeup can't slip in between checking the object and blocking on it.
+     * Kernel objects are named by handles of the caller's process, resolved before any lock is taken.
+     * Buffers and lock words passed in are checked against the caller's process's memory first, see IsUserRange.
+     */
+
+    /// @return Whether the caller's process can use a range it passed in with the wanted permissions.
+    static bool
+    IsUserRange(const Thread& caller, const volatile void* const start, const size_t length, const MemPermisions wanted)
+    {
+        KernelLock::Guard guard(memoryLock);
+        return caller.getProcess().ValidateUserRange(reinterpret_cast<uintptr_t>(start), length, wanted);
+    }
+
+    /// @return Whether the caller's process can read and write a mutex lock word it passed in.
+    static bool
+    IsUserLockWord(const Thread& caller, volatile uint32_t* const state)
+    {
+        return IsUserRange(caller, state, sizeof(*state), MemPermisions::Read | MemPermisions::Write);
+    }
+
+    static uint32_t
+    HandleGetCpuUsage(Thread& caller, CpuUsageEntry* const entries, const uint32_t numEntries)
+    {
+        if (numEntries > (SIZE_MAX / sizeof(CpuUsageEntry))) return 0;
+        if (!IsUserRange(caller, entries, numEntries * sizeof(CpuUsageEntry), MemPermisions::Write)) return 0;
+        return processManager.GetCpuUsage(entries, numEntries);
+    }
+
+    static void
+    HandlePrintCpuUsage(Thread&)
+    {
+        cpuAccounting.Report(USART1);
+    }
+
+    static KernelResultStatus
+    HandleSetDeadlineParameters(Thread& caller, const DeadlineParameters* const parameters)
+    {
+        if (!IsUserRange(caller, parameters, sizeof(*parameters), MemPermisions::Read)) return KernelResultStatus::Error;
+        return processManager.SetDeadlineParameters(caller, *parameters);
+    }
+
+    static KernelResultStatus
+    HandleSetCpuQuota(Thread& caller, const uint32_t processId, const uint32_t budgetMs, const uint32_t periodMs)
+    {
+        Process* const process = processManager.FindProcess(processId);
+        if (process == nullptr) return KernelResultStatus::Error;
+        // Only whoever started a process limits it, so it can't lift its own quota.
+        const Process& callerProcess = caller.getProcess();
+        if ((&callerProcess != processManager.GetKernelProcess()) && (process->GetParentId() != callerProcess.GetId()))
+        {
+            return KernelResultStatus::Error;
+        }
+        return processManager.SetCpuQuota(*process, budgetMs, periodMs);
+    }
+
+    static void
+    HandleWaitForNextPeriod(Thread&)
+    {
+        processManager.WaitForNextPeriod(0);
+    }
+
+    static uint32_t
+    HandleGetDeadlineMisses(Thread& caller)
+    {
+        return caller.GetDeadlineState().Misses;
+    }
+
+    static KernelResultStatus
+    HandleDumpTrace(Thread&)
+    {
+        return TraceDump(USART1) ? KernelResultStatus::Success : KernelResultStatus::Error;
+    }
+
+    static uint32_t
+    HandleGetThreadId(Thread& caller)
+    {
+        return caller.getId();
+    }
+
+    static KernelResultStatus
+    HandleLockMutex(Thread& caller, volatile uint32_t* const state)
+    {
+        if (!IsUserLockWord(caller, state)) return KernelResultStatus::Error;
+        KernelLock::Guard guard(schedulerLock);
+        return mutexManager.Lock(0, state);
+    }
+
+    static KernelResultStatus
+    HandleUnlockMutex(Thread& caller, volatile uint32_t* const state)
+    {
+        if (!IsUserLockWord(caller, state)) return KernelResultStatus::Error;
+        KernelLock::Guard guard(schedulerLock);
+        return mutexManager.Unlock(0, state);
+    }
+
+    /// @return The object a handle of the caller's process names, nullptr unless it is of that kind with those rights.
+    template <class T>
+    static T*
+    ResolveHandle(const Thread& caller, const Handle handle, const HandleRights rights)
+    {
+        return caller.getProcess().GetHandles().Resolve<T>(handle, rights);
+    }
+
+    static KernelResultStatus
+    HandleSemaphoreWait(Thread& caller, const Handle handle, const uint32_t timeoutTicks)
+    {
+        Semaphore* const semaphore = ResolveHandle<Semaphore>(caller, handle, HandleRights::Wait);
+        if (semaphore == nullptr) return KernelResultStatus::Error;
+        KernelLock::Guard guard(schedulerLock);
+        return semaphore->Wait(0, timeoutTicks);
+    }
+
+    static KernelResultStatus
+    HandleSemaphorePost(Thread& caller, const Handle handle)
+    {
+        Semaphore* const semaphore = ResolveHandle<Semaphore>(caller, handle, HandleRights::Signal);
+        if (semaphore == nullptr) return KernelResultStatus::Error;
+        return semaphore->PostFromIsr();
+    }
+
+    static uint32_t
+    HandleEventFlagsWait(Thread& caller, const Handle handle, const uint32_t mask, const uint32_t options, const uint32_t timeoutTicks)
+    {
+        EventFlags* const flags = ResolveHandle<EventFlags>(caller, handle, HandleRights::Wait);
+        if (flags == nullptr) return 0;
+        KernelLock::Guard guard(schedulerLock);
+        return flags->Wait(0, mask, options, timeoutTicks);
+    }
+
+    static KernelResultStatus
+    HandleEventFlagsSet(Thread& caller, const Handle handle, const uint32_t toSet)
+    {
+        EventFlags* const flags = ResolveHandle<EventFlags>(caller, handle, HandleRights::Signal);
+        if (flags == nullptr) return KernelResultStatus::Error;
+        flags->SetFromIsr(toSet);
+        return KernelResultStatus::Success;
+    }
+
+    static KernelResultStatus
+    HandleEventFlagsClear(Thread& caller, const Handle handle, const uint32_t toClear)
+    {
+        EventFlags* const flags = ResolveHandle<EventFlags>(caller, handle, HandleRights::Signal);
+        if (flags == nullptr) return KernelResultStatus::Error;
+        KernelLock::Guard guard(schedulerLock);
+        flags->Clear(toClear);
+        return KernelResultStatus::Success;
+    }
+
+    static KernelResultStatus
+    HandleConditionWait(Thread& caller, const Handle handle, volatile uint32_t* const mutexState, const uint32_t timeoutTicks)
+    {
+        ConditionVariable* const condition = ResolveHandle<ConditionVariable>(caller, handle, HandleRights::Wait);
+        if ((condition == nullptr) || !IsUserLockWord(caller, mutexState)) return KernelResultStatus::Error;
+        KernelLock::Guard guard(schedulerLock);
+        return condition->Wait(0, mutexState, timeoutTicks);
+    }
+
+    static KernelResultStatus
+    HandleConditionNotifyOne(Thread& caller, const Handle handle)
+    {
+        ConditionVariable* const condition = ResolveHandle<ConditionVariable>(caller, handle, HandleRights::Signal);
+        if (condition == nullptr) return KernelResultStatus::Error;
+        condition->NotifyOneFromIsr();
+        return KernelResultStatus::Success;
+    }
+
+    static KernelResultStatus
+    HandleConditionNotifyAll(Thread& caller, const Handle handle)
+    {
+        ConditionVariable* const condition = ResolveHandle<ConditionVariable>(caller, handle, HandleRights::Signal);
+        if (condition == nullptr) return KernelResultStatus::Error;
+        condition->NotifyAllFromIsr();
+        return KernelResultStatus::Success;
+    }
+
+    static KernelResultStatus
+    HandleNotifyThread(Thread&, const uint32_t threadId, const NotifyAction action, const uint32_t value)
+    {
+        Thread* const thread = processManager.FindThread(threadId);
+        if ((thread == nullptr) || (action >= NotifyAction::NUM_ACTIONS)) return KernelResultStatus::Error;
+        processManager.NotifyThreadFromIsr(*thread, action, value);
+        return KernelResultStatus::Success;
+    }
+
+    static uint32_t
+    HandleWaitForNotification(Thread&, const uint32_t clearBits, const uint32_t timeoutTicks)
+    {
+        return processManager.WaitForNotification(0, clearBits, timeoutTicks);
+    }
+
+    static KernelResultStatus
+    HandleIpcSend(Thread&, const uint32_t toThreadId, const uint32_t timeoutTicks)
+    {
+        KernelLock::Guard guard(ipcLock);
+        return ipcManager.Send(0, toThreadId, timeoutTicks);
+    }
+
+    static KernelResultStatus
+    HandleIpcCall(Thread&, const uint32_t toThreadId, const uint32_t timeoutTicks)
+    {
+        KernelLock::Guard guard(ipcLock);
+        return ipcManager.Call(0, toThreadId, timeoutTicks);
+    }
+
+    static uint32_t
+    HandleIpcReceive(Thread&, const uint32_t fromThreadId, const uint32_t timeoutTicks)
+    {
+        KernelLock::Guard guard(ipcLock);
+        return ipcManager.Receive(0, fromThreadId, timeoutTicks);
+    }
+
+    static KernelResultStatus
+    HandleIpcReply(Thread&, const uint32_t toThreadId)
+    {
+        KernelLock::Guard guard(ipcLock);
+        return ipcManager.Reply(0, toThreadId);
+    }
+
+    static uint32_t
+    HandleIpcReplyWait(Thread&, const uint32_t toThreadId, const uint32_t timeoutTicks)
+    {
+        KernelLock::Guard guard(ipcLock);
+        return ipcManager.ReplyWait(0, toThreadId, timeoutTicks);
+    }
+
+    static KernelResultStatus
+    HandleRegionQueueSend(Thread& caller, const Handle handle, const uintptr_t regionStart, const uint32_t timeoutTicks)
+    {
+        RegionQueue* const queue = ResolveHandle<RegionQueue>(caller, handle, HandleRights::Signal);
+        if (queue == nullptr) return KernelResultStatus::Error;
+        KernelLock::Guard ipc(ipcLock);
+        KernelLock::Guard memory(memoryLock);
+        return queue->Send(0, regionStart, timeoutTicks);
+    }
+
+    static uintptr_t
+    HandleRegionQueueReceive(Thread& caller, const Handle handle, const uint32_t timeoutTicks)
+    {
+        RegionQueue* const queue = ResolveHandle<RegionQueue>(caller, handle, HandleRights::Wait);
+        if (queue == nullptr) return 0;
+        KernelLock::Guard ipc(ipcLock);
+        KernelLock::Guard memory(memoryLock);
+        return queue->Receive(0, timeoutTicks);
+    }
+
+    static size_t
+    HandleGetMemRegionSize(Thread& caller, const uintptr_t start)
+    {
+        KernelLock::Guard guard(memoryLock);
+        return caller.getProcess().GetMemRegionSize(start);
+    }
+
+    static uintptr_t
+    HandleSharedMemoryAttach(Thread& caller, const uint32_t key, const size_t size, const MemPermisions permissions)
+    {
+        KernelLock::Guard guard(memoryLock);
+        return sharedMemoryManager.Attach(caller.getProcess(), key, size, permissions);
+    }
+
+    static KernelResultStatus
+    HandleSharedMemoryDetach(Thread& caller, const uintptr_t start)
+    {
+        KernelLock::Guard guard(memoryLock);
+        return sharedMemoryManager.Detach(caller.getProcess(), start);
+    }
+
+    static KernelResultStatus
+    HandleRegisterSyscallRing(Thread& caller, SyscallRing* const ring)
+    {
+        if (!IsUserRange(caller, ring, sizeof(*ring), MemPermisions::Read | MemPermisions::Write)) return KernelResultStatus::Error;
+        KernelLock::Guard guard(processLock);
+        caller.getProcess().SetSyscallRing(ring);
+        return KernelResultStatus::Success;
+    }
+
+    static uint32_t
+    HandleSubmitSyscalls(Thread& caller)
+    {
+        SyscallRing* const ring = caller.getProcess().GetSyscallRing();
+        if (ring == nullptr) return 0;
+        return ProcessSyscallRing(*ring, caller);
+    }
+
+    static uint32_t
+    HandleGetTickCount(Thread&)
+    {
+        return processManager.GetTickCount();
+    }
+
+    static void
+    HandleYield(Thread&)
+    {
+        // Preempting the caller through PendSV gives up the rest of its time slice without saving its registers here.
+        request_reschedule();
+    }
+
+    static uint32_t
+    HandleSubmitAsync(Thread& caller, AsyncRequest* const request)
+    {
+        if (!IsUserRange(caller, request, sizeof(*request), MemPermisions::Read | MemPermisions::Write)) return 0;
+        return asyncManager.Submit(caller, *request);
+    }
+
+    /// @brief Give the caller's process a handle with every right to a newly made kernel object.
+    /// The handle holds the object's only reference, it is destroyed once every handle to it is closed.
+    /// @return The handle, HANDLE_NONE if there was no memory for the object or its process's table is full.
+    template <class T>
+    static Handle
+    InsertNewObject(Thread& caller, T* const object)
+    {
+        if (object == nullptr) return HANDLE_NONE;
+        Handle handle;
+        {
+            KernelLock::Guard guard(processLock);
+            handle = caller.getProcess().GetHandles().Insert(*object, HandleRights::All);
+        }
+        if (handle == HANDLE_NONE) delete object;
+        return handle;
+    }
+
+    static Handle
+    HandleCreateSemaphore(Thread& caller, const uint32_t initialCount, const uint32_t maxCount)
+    {
+        if ((maxCount == 0) || (initialCount > maxCount)) return HANDLE_NONE;
+        return InsertNewObject(caller, new Semaphore(initialCount, maxCount));
+    }
+
+    static Handle
+    HandleCreateEventFlags(Thread& caller)
+    {
+        return InsertNewObject(caller, new EventFlags());
+    }
+
+    static Handle
+    HandleCreateConditionVariable(Thread& caller)
+    {
+        return InsertNewObject(caller, new ConditionVariable());
+    }
+
+    static Handle
+    HandleCreateRegionQueue(Thread& caller, const uint32_t depth)
+    {
+        if ((depth == 0) || (depth > REGION_QUEUE_MAX_DEPTH)) return HANDLE_NONE;
+        return InsertNewObject(caller, new RegionQueue(depth));
+    }
+
+    static KernelResultStatus
+    HandleCloseHandle(Thread& caller, const Handle handle)
+    {
+        KernelLock::Guard guard(processLock);
+        return caller.getProcess().GetHandles().Close(handle);
+    }
+
+    static Handle
+    HandleDuplicateHandle(Thread& caller, const Handle handle, const uint32_t processId, const HandleRights rights)
+    {
+        Process* const target = processManager.FindProcess(processId);
+        if (target == nullptr) return HANDLE_NONE;
+        KernelLock::Guard guard(processLock);
+        return caller.getProcess().GetHandles().Duplicate(handle, target->GetHandles(), rights);
+    }
+
+    /// @brief Every request, indexed by its ID. Generated from API_REQUEST_LIST, which also fixes each handler's type.
+    static constexpr RequestTableEntry requestTable[] = {
+        {ApiRequestId::None, nullptr, false, false, false},
+#define API_REQUEST_TABLE_ENTRY(name, result, params, batchable, fast, async)                                                   \
+        {ApiRequestId::name,                                                                                                    \
+         RequestAdapter<static_cast<details::HandlerSignature<result params>::Type>(Handle##name)>::Handle,                     \
+         batchable,                                                                                                             \
+         fast,                                                                                                                  \
+         async},
+        API_REQUEST_LIST(API_REQUEST_TABLE_ENTRY, API_REQUEST_TABLE_ENTRY)
+#undef API_REQUEST_TABLE_ENTRY
+    };
+
+    static constexpr bool
+    IsRequestTableComplete()
+    {
+        if ((sizeof(requestTable) / sizeof(requestTable[0])) != static_cast<uint32_t>(ApiRequestId::NUM_REQUESTS)) return false;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(ApiRequestId::NUM_REQUESTS); i++)
+        {
+            if (requestTable[i].Id != static_cast<ApiRequestId>(i)) return false;
+            // Async requests run on the async worker, where nothing could block or be switched away from.
+            if (requestTable[i].Async && (!requestTable[i].Batchable || requestTable[i].Fast)) return false;
+        }
+        return true;
+    }
+    static_assert(IsRequestTableComplete(), "The request table must have one entry per ApiRequestId, in order, "
+                                            "and only batchable requests that aren't fast can be async");
+
+    static bool
+    IsBatchable(const ApiRequestId id)
+    {
+        return (id < ApiRequestId::NUM_REQUESTS) && requestTable[static_cast<uint32_t>(id)].Batchable;
+    }
+
+    bool
+    KernelApi::IsFastRequest(const ApiRequestId id) const
+    {
+        return (id < ApiRequestId::NUM_REQUESTS) && requestTable[static_cast<uint32_t>(id)].Fast;
+    }
+
+    bool
+    KernelApi::IsAsyncRequest(const ApiRequestId id) const
+    {
+        return (id < ApiRequestId::NUM_REQUESTS) && requestTable[static_cast<uint32_t>(id)].Async;
+    }
+
     KernelApi::KernelApi()
         : ApiEntry(ApiEntryFunction)
     {
     }
 
-    void
+    uint32_t
     KernelApi::ProcessRequest(const ApiRequest& request)
     {
+        return ProcessRequest(*processManager.GetRunningThread(0), request);
+    }
+
+    uint32_t
+    KernelApi::ProcessRequest(Thread& caller, const ApiRequest& request)
+    {
+        if (request.GetRawId() >= static_cast<uint32_t>(ApiRequestId::NUM_REQUESTS)) return static_cast<uint32_t>(KernelResultStatus::Error);
+        const RequestHandler handler = requestTable[request.GetRawId()].Handler;
+        if (handler == nullptr) return static_cast<uint32_t>(KernelResultStatus::Error);
+        return handler(caller, request);
     }
 }
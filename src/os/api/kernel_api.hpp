@@ -5,6 +5,8 @@
 #include "misc.hpp"
 #include "savedRegisters.hpp"
 
+class Thread;
+
 namespace os::api
 {
     class KernelApi
@@ -13,7 +15,17 @@ namespace os::api
             VoidFunction ApiEntry;
 
             KernelApi();
-            void ProcessRequest(const ApiRequest& request);
+            /// @brief Carry out a request made by a thread.
+            /// @return The result to hand back to the thread in R0.
+            uint32_t ProcessRequest(const ApiRequest& request);
+            /// @brief Carry out a request on behalf of a thread that need not be running, e.g. an async request.
+            uint32_t ProcessRequest(Thread& caller, const ApiRequest& request);
+            /// @return Whether a request is fast: it can't block the caller or switch threads itself, so it can
+            ///         be carried out without saving the caller's registers. Fast requests that wake a thread
+            ///         that should preempt the caller leave the switch to PendSV, like an interrupt handler.
+            bool IsFastRequest(const ApiRequestId id) const;
+            /// @return Whether a request can be made through ApiRequestId::SubmitAsync.
+            bool IsAsyncRequest(const ApiRequestId id) const;
     };
 
     extern KernelApi kernelApi;
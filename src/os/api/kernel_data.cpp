@@ -0,0 +1,84 @@
+#include "kernel_data.hpp"
+#include "mpu.h"
+#include "stm32_rtc.h"
+#include "sys_ctl_block.h"
+
+namespace os::api
+{
+    KernelData kernelData;
+
+    /// @return The time in seconds since 2000-01-01 00:00, 0 if it isn't a valid date.
+    static uint32_t
+    SecondsSince2000(const RTC_datetime& datetime)
+    {
+        static const uint16_t daysBeforeMonth[] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+        if ((datetime.year < 2000) || (datetime.month < 1) || (datetime.month > 12) || (datetime.day < 1)) return 0;
+
+        const uint32_t years = datetime.year - 2000u;
+        // Every 4th year is a leap year for as long as the RTC can count, 2000 included.
+        uint32_t days = (years * 365u) + ((years + 3u) / 4u) + daysBeforeMonth[datetime.month - 1] + (datetime.day - 1u);
+        if (((years % 4u) == 0) && (datetime.month > 2)) days++;
+        return (((days * 24u) + datetime.hours) * 60u + datetime.minutes) * 60u + datetime.seconds;
+    }
+
+    KernelData::KernelData()
+        : _page()
+    {
+    }
+
+    KernelData::~KernelData()
+    {
+        // Intentionally do nothing.
+    }
+
+    void
+    KernelData::BeginUpdate()
+    {
+        _page.Sequence = _page.Sequence + 1;
+        asm volatile("" ::: "memory");
+    }
+
+    void
+    KernelData::EndUpdate()
+    {
+        asm volatile("" ::: "memory");
+        _page.Sequence = _page.Sequence + 1;
+    }
+
+    void
+    KernelData::Initialize()
+    {
+        RTC_datetime datetime{};
+        const uint32_t wallClock = (RTC->get_datetime(&datetime) == 0) ? SecondsSince2000(datetime) : 0;
+
+        BeginUpdate();
+        _page.TickPeriodMs = SYS_TICK_PERIOD_MS;
+        const uint32_t elapsedSeconds = static_cast<uint32_t>((static_cast<uint64_t>(_page.TickCount) * _page.TickPeriodMs) / 1000u);
+        _page.WallClockOffset = (wallClock > elapsedSeconds) ? (wallClock - elapsedSeconds) : 0;
+        EndUpdate();
+
+        // Privileged code keeps the default memory map, this only lets threads read the page.
+        mpu_region region;
+        region.set_addr_size(reinterpret_cast<uintptr_t>(&_page), KERNEL_DATA_PAGE_SIZE_LOG2 - 1);
+        region.set_attr(mpu_region::TEX_0, false, true, true, false);
+        region.set_access_perms(mpu_region::AP_RW_RO);
+        MPU->set_config(KERNEL_DATA_MPU_REGION, region);
+        MPU->region_enable(KERNEL_DATA_MPU_REGION);
+    }
+
+    void
+    KernelData::PublishTick(const uint32_t tickCount)
+    {
+        BeginUpdate();
+        _page.TickCount = tickCount;
+        EndUpdate();
+    }
+
+    void
+    KernelData::PublishRunningThread(const uint32_t threadId)
+    {
+        BeginUpdate();
+        _page.CurrentThreadId = threadId;
+        EndUpdate();
+    }
+}
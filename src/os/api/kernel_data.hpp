@@ -0,0 +1,117 @@
+#ifndef _KERNEL_DATA_H
+#define _KERNEL_DATA_H
+
+#include <cstdint>
+
+/* Kernel data page.
+ * A small page the kernel keeps up to date and maps read-only into every process, so threads can read the time
+ * or their own thread ID with a few loads instead of a service request.
+ * The kernel bumps Sequence before and after every update, readers retry until they see the same even value on
+ * both sides of their reads.
+ */
+
+// log2 of the page size. The page is a single MPU region, which must be aligned to its size.
+#define KERNEL_DATA_PAGE_SIZE_LOG2 5u
+#define KERNEL_DATA_PAGE_SIZE (1u << KERNEL_DATA_PAGE_SIZE_LOG2)
+// MPU region that maps the page. Where regions overlap the highest numbered one applies, so it is the last.
+#define KERNEL_DATA_MPU_REGION 7u
+
+namespace os::api
+{
+    class KernelDataPage
+    {
+        public:
+            /// @brief Odd while the kernel is part way through an update.
+            volatile uint32_t Sequence;
+            /// @brief Ticks since the scheduler started.
+            uint32_t TickCount;
+            /// @brief Length of a tick in milliseconds.
+            uint32_t TickPeriodMs;
+            /// @brief RTC time when the tick count was 0, in seconds since 2000-01-01 00:00. 0 if the RTC isn't set.
+            uint32_t WallClockOffset;
+            /// @brief ID of the thread running on core 0.
+            uint32_t CurrentThreadId;
+    };
+
+    static_assert(sizeof(KernelDataPage) <= KERNEL_DATA_PAGE_SIZE, "The kernel data page must fit its MPU region");
+
+    /// @brief Owns the kernel data page. Only the kernel updates it, threads read it through the functions below.
+    class KernelData
+    {
+        private:
+            alignas(KERNEL_DATA_PAGE_SIZE) KernelDataPage _page;
+
+            void BeginUpdate();
+            void EndUpdate();
+
+        public:
+            KernelData();
+            KernelData(const KernelData&) = delete;
+            KernelData(KernelData&&) = delete;
+            ~KernelData();
+            KernelData& operator=(const KernelData&) = delete;
+            KernelData& operator=(KernelData&&) = delete;
+
+            /// @brief Take the wall clock time from the RTC and map the page read-only for unprivileged code.
+            /// Must be called after the MPU is enabled.
+            void Initialize();
+            /// @brief Called from the scheduler with interrupts disabled, like everything else that updates the page.
+            void PublishTick(const uint32_t tickCount);
+            void PublishRunningThread(const uint32_t threadId);
+
+            const KernelDataPage& GetPage() const { return _page; };
+    };
+
+    extern KernelData kernelData;
+
+    /// @brief Take a consistent copy of the kernel data page, without making a request.
+    inline KernelDataPage
+    ReadKernelData()
+    {
+        const KernelDataPage& page = kernelData.GetPage();
+        KernelDataPage copy;
+        do
+        {
+            copy.Sequence = page.Sequence;
+            asm volatile("" ::: "memory");
+            copy.TickCount = page.TickCount;
+            copy.TickPeriodMs = page.TickPeriodMs;
+            copy.WallClockOffset = page.WallClockOffset;
+            copy.CurrentThreadId = page.CurrentThreadId;
+            asm volatile("" ::: "memory");
+        } while (((copy.Sequence & 1u) != 0) || (page.Sequence != copy.Sequence));
+        return copy;
+    }
+
+    /// @return Ticks since the scheduler started, the same as ApiRequestId::GetTickCount.
+    inline uint32_t
+    ReadTickCount()
+    {
+        return ReadKernelData().TickCount;
+    }
+
+    /// @return Milliseconds since the scheduler started, to the nearest tick.
+    inline uint64_t
+    ReadMonotonicTimeMs()
+    {
+        const KernelDataPage data = ReadKernelData();
+        return static_cast<uint64_t>(data.TickCount) * data.TickPeriodMs;
+    }
+
+    /// @return Seconds since 2000-01-01 00:00 by the RTC, or since the scheduler started if the RTC isn't set.
+    inline uint32_t
+    ReadWallClockSeconds()
+    {
+        const KernelDataPage data = ReadKernelData();
+        return data.WallClockOffset + static_cast<uint32_t>((static_cast<uint64_t>(data.TickCount) * data.TickPeriodMs) / 1000u);
+    }
+
+    /// @return The calling thread's ID, the same as ApiRequestId::GetThreadId.
+    inline uint32_t
+    ReadCurrentThreadId()
+    {
+        return ReadKernelData().CurrentThreadId;
+    }
+}
+
+#endif /* _KERNEL_DATA_H */
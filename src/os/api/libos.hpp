@@ -0,0 +1,42 @@
+#ifndef _LIBOS_H
+#define _LIBOS_H
+
+#include "api_request.hpp"
+#include "api_request_list.hpp"
+#include "handle.hpp"
+#include "kernel_result_status.hpp"
+#include "mem_region.hpp"
+#include "notification.hpp"
+#include "service_request.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// Requests only pass pointers to these, threads don't need to see inside them.
+class CpuUsageEntry;
+class DeadlineParameters;
+namespace os::api
+{
+    class AsyncRequest;
+    class SyscallRing;
+}
+
+/* One inline stub per kernel request, generated from API_REQUEST_LIST so they always match the kernel's handlers.
+ * os::libos::Name(params...) makes ApiRequestId::Name with the parameters in R0-R3 and returns R0 as the request's result.
+ * These are the raw requests, e.g. the os::sync and os::ipc calls wrap them to take objects by reference.
+ */
+namespace os::libos
+{
+#define LIBOS_STUB(name, result, params, batchable, fast, async)                                                        \
+    template <typename... Args>                                                                                         \
+    __attribute__((always_inline)) inline result                                                                        \
+    name(const Args... args)                                                                                            \
+    {                                                                                                                   \
+        return os::api::RequestStub<os::api::ApiRequestId::name, result params>::Call(args...);                       \
+    }
+#define LIBOS_NO_STUB(name, result, params, batchable, fast, async)
+    API_REQUEST_LIST(LIBOS_STUB, LIBOS_NO_STUB)
+#undef LIBOS_STUB
+#undef LIBOS_NO_STUB
+}
+
+#endif /* _LIBOS_H */
@@ -0,0 +1,79 @@
+#ifndef _REQUEST_HANDLER_H
+#define _REQUEST_HANDLER_H
+
+#include "api_request.hpp"
+#include "kernel_result_status.hpp"
+#include "thread.h"
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace os::api
+{
+    /// @brief Carries out one kind of request for the thread that made it.
+    /// @return The result to hand back to the thread in R0.
+    using RequestHandler = uint32_t (*)(Thread& caller, const ApiRequest& request);
+
+    namespace details
+    {
+        /// @brief The type of the handler for a request with the given signature, see API_REQUEST_LIST.
+        template <typename Signature>
+        class HandlerSignature;
+
+        template <typename Result, typename... Params>
+        class HandlerSignature<Result(Params...)>
+        {
+            public:
+                using Type = Result (*)(Thread&, Params...);
+        };
+    }
+
+    /// @brief Adapts a handler declared with the types it actually takes, e.g.
+    ///        KernelResultStatus SemaphoreWait(Thread& caller, Handle semaphore, uint32_t timeoutTicks),
+    ///        to a RequestHandler. Each parameter comes from the next argument register.
+    template <auto Handler>
+    class RequestAdapter;
+
+    template <typename Result, typename... Params, Result (*Handler)(Thread&, Params...)>
+    class RequestAdapter<Handler>
+    {
+            static_assert(sizeof...(Params) <= API_REQUEST_MAX_PARAMS, "Requests take one parameter per argument register");
+
+        private:
+            template <uint32_t... Indices>
+            static uint32_t Call(Thread& caller, const ApiRequest& request, std::integer_sequence<uint32_t, Indices...>)
+            {
+                if constexpr (std::is_void_v<Result>)
+                {
+                    Handler(caller, details::FromRegister<Params>(request.GetParam(Indices))...);
+                    return 0;
+                }
+                else
+                {
+                    return details::ToRegister(Handler(caller, details::FromRegister<Params>(request.GetParam(Indices))...));
+                }
+            }
+
+        public:
+            static uint32_t Handle(Thread& caller, const ApiRequest& request)
+            {
+                return Call(caller, request, std::make_integer_sequence<uint32_t, sizeof...(Params)>{});
+            }
+    };
+
+    /// @brief A row of the request table.
+    class RequestTableEntry
+    {
+        public:
+            ApiRequestId Id;
+            RequestHandler Handler;
+            /// @brief Whether the request can be taken from a SyscallRing, i.e. it never blocks the caller.
+            bool Batchable;
+            /// @brief Whether the request runs straight from the SVC handler, see KernelApi::IsFastRequest.
+            bool Fast;
+            /// @brief Whether the request can be made through ApiRequestId::SubmitAsync, see KernelApi::IsAsyncRequest.
+            bool Async;
+    };
+}
+
+#endif /* _REQUEST_HANDLER_H */
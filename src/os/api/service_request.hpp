@@ -0,0 +1,61 @@
+#ifndef _SERVICE_REQUEST_H
+#define _SERVICE_REQUEST_H
+
+#include "api_request.hpp"
+#include <cstdint>
+#include <type_traits>
+
+namespace os::api
+{
+    /// @brief Make a request to the kernel from a thread. Traps into SVCall_Handler, which writes the result back to R0.
+    /// The request ID is the SVC instruction's immediate, so all four argument registers are free for parameters.
+    /// @tparam Id The service being requested.
+    /// @param param1 First parameter of the request, and so on.
+    /// @return The request's result.
+    template <ApiRequestId Id>
+    __attribute__((always_inline)) inline uint32_t
+    ServiceRequest(const uint32_t param1 = 0, const uint32_t param2 = 0, const uint32_t param3 = 0, const uint32_t param4 = 0)
+    {
+        static_assert((Id != ApiRequestId::None) && (Id < ApiRequestId::NUM_REQUESTS), "Not a request");
+        static_assert(static_cast<uint32_t>(ApiRequestId::NUM_REQUESTS) <= SVC_NUMBER_MAX, "Request IDs must fit the SVC immediate");
+        register uint32_t r0 asm("r0") = param1;
+        register uint32_t r1 asm("r1") = param2;
+        register uint32_t r2 asm("r2") = param3;
+        register uint32_t r3 asm("r3") = param4;
+        asm volatile("SVC    %[id]\n\t"
+                     : "+r"(r0)
+                     : [id] "i"(static_cast<uint32_t>(Id)),
+                       "r"(r1),
+                       "r"(r2),
+                       "r"(r3)
+                     : "memory");
+        return r0;
+    }
+
+    /// @brief Makes a request with the parameter and result types it is declared with in API_REQUEST_LIST.
+    /// Each parameter goes straight into the next argument register, so at any optimisation level the call is just
+    /// the register moves and the SVC instruction.
+    /// @tparam Id The service being requested.
+    /// @tparam Signature The request's Result(Params...).
+    template <ApiRequestId Id, typename Signature>
+    class RequestStub;
+
+    template <ApiRequestId Id, typename Result, typename... Params>
+    class RequestStub<Id, Result(Params...)>
+    {
+            static_assert(sizeof...(Params) <= API_REQUEST_MAX_PARAMS, "Requests take one parameter per argument register");
+
+        public:
+            __attribute__((always_inline)) static inline Result Call(const Params... params)
+            {
+                const uint32_t registers[API_REQUEST_MAX_PARAMS] = {details::ToRegister(params)...};
+                const uint32_t result = ServiceRequest<Id>(registers[0], registers[1], registers[2], registers[3]);
+                if constexpr (!std::is_void_v<Result>)
+                {
+                    return details::FromRegister<Result>(result);
+                }
+            }
+    };
+}
+
+#endif /* _SERVICE_REQUEST_H */
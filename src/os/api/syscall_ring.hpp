@@ -0,0 +1,99 @@
+#ifndef _SYSCALL_RING_H
+#define _SYSCALL_RING_H
+
+#include "api_request.hpp"
+#include "kernel_result_status.hpp"
+#include "libos.hpp"
+#include <cstdint>
+
+// Must be a power of 2, indices are free-running and wrap with a mask.
+#define SYSCALL_RING_ENTRIES 16u
+
+namespace os::api
+{
+    /// @brief A request queued in a SyscallRing.
+    class SyscallSubmission
+    {
+        public:
+            ApiRequestId Id;
+            /// @brief One per argument register, as the request would take them.
+            uint32_t Params[API_REQUEST_MAX_PARAMS];
+            /// @brief Copied to the completion, to match it up with the submission.
+            uint32_t UserData;
+    };
+
+    /// @brief The result of a request taken from a SyscallRing.
+    class SyscallCompletion
+    {
+        public:
+            uint32_t UserData;
+            uint32_t Result;
+    };
+
+    /* Submission and completion queues shared between a process and the kernel, so a thread can queue up
+     * several requests and have them all carried out by a single ApiRequestId::SubmitSyscalls.
+     * Each side only writes its own indices: the thread writes SubmitHead and CompleteTail, the kernel SubmitTail and CompleteHead.
+     * Requests that can block the caller are completed with KernelResultStatus::Error, they need a request of their own.
+     */
+    class SyscallRing
+    {
+        public:
+            volatile uint32_t SubmitHead;
+            volatile uint32_t SubmitTail;
+            volatile uint32_t CompleteHead;
+            volatile uint32_t CompleteTail;
+            SyscallSubmission Submissions[SYSCALL_RING_ENTRIES];
+            SyscallCompletion Completions[SYSCALL_RING_ENTRIES];
+
+            /// @brief Queue a request, with its parameters in the order it takes them. Unused ones can be left out.
+            ///        Nothing happens until the next SubmitSyscalls.
+            /// @param userData Copied to the request's completion.
+            /// @return false if the submission queue is full.
+            bool Submit(const ApiRequestId id, const uint32_t userData, const uint32_t param1 = 0, const uint32_t param2 = 0,
+                        const uint32_t param3 = 0, const uint32_t param4 = 0)
+            {
+                const uint32_t head = SubmitHead;
+                if ((head - SubmitTail) == SYSCALL_RING_ENTRIES) return false;
+                SyscallSubmission& submission = Submissions[head & (SYSCALL_RING_ENTRIES - 1)];
+                submission.Id = id;
+                submission.Params[0] = param1;
+                submission.Params[1] = param2;
+                submission.Params[2] = param3;
+                submission.Params[3] = param4;
+                submission.UserData = userData;
+                // The entry must be written before the kernel can see it.
+                asm volatile("" ::: "memory");
+                SubmitHead = head + 1;
+                return true;
+            }
+
+            /// @brief Take the oldest completion.
+            /// @return false if there are none.
+            bool Complete(SyscallCompletion& completion)
+            {
+                const uint32_t tail = CompleteTail;
+                if (tail == CompleteHead) return false;
+                completion = Completions[tail & (SYSCALL_RING_ENTRIES - 1)];
+                asm volatile("" ::: "memory");
+                CompleteTail = tail + 1;
+                return true;
+            }
+    };
+
+    /// @brief Register the calling thread's process's ring. Must be zeroed, in memory the process owns.
+    inline KernelResultStatus
+    RegisterSyscallRing(SyscallRing& ring)
+    {
+        return os::libos::RegisterSyscallRing(&ring);
+    }
+
+    /// @brief Have the kernel carry out every queued request, as far as there is room for their completions.
+    /// @return The number of requests carried out.
+    inline uint32_t
+    SubmitSyscalls()
+    {
+        return os::libos::SubmitSyscalls();
+    }
+}
+
+#endif /* _SYSCALL_RING_H */
@@ -0,0 +1,148 @@
+#include "ipc.hpp"
+#include "proc_mgr.h"
+
+IpcManager ipcManager;
+
+IpcManager::IpcManager()
+{
+}
+
+IpcManager::~IpcManager()
+{
+    // Intentionally do nothing.
+}
+
+void
+IpcManager::Transfer(const Thread& sender, Thread& receiver)
+{
+    receiver._savedRegs.R4 = sender._savedRegs.R4;
+    receiver._savedRegs.R5 = sender._savedRegs.R5;
+    receiver._savedRegs.R6 = sender._savedRegs.R6;
+    receiver._savedRegs.R7 = sender._savedRegs.R7;
+    receiver._savedRegs.R8 = sender._savedRegs.R8;
+    receiver._savedRegs.R9 = sender._savedRegs.R9;
+    receiver._savedRegs.R10 = sender._savedRegs.R10;
+    receiver._savedRegs.R11 = sender._savedRegs.R11;
+}
+
+bool
+IpcManager::IsReceivingFrom(const Thread& receiver, const Thread& sender)
+{
+    return (receiver._state == ThreadState::Blocked)
+           && (receiver._ipcPhase == IpcPhase::Receiving)
+           && ((receiver._ipcPartner == IPC_ANY_THREAD) || (receiver._ipcPartner == sender.getId()));
+}
+
+Thread*
+IpcManager::FindSender(Thread& receiver, const uint32_t fromThreadId)
+{
+    for (Thread& sender : receiver._ipcSenders)
+    {
+        if ((fromThreadId == IPC_ANY_THREAD) || (sender.getId() == fromThreadId)) return &sender;
+    }
+    return nullptr;
+}
+
+KernelResultStatus
+IpcManager::Deliver(uint32_t core, const uint32_t toThreadId, const uint32_t timeoutTicks, const bool call)
+{
+    Thread& caller = *processManager.GetRunningThread(core);
+    Thread* const receiver = processManager.FindThread(toThreadId);
+    if ((receiver == nullptr) || (receiver == &caller)) return KernelResultStatus::Error;
+
+    if (IsReceivingFrom(*receiver, caller))
+    {
+        Transfer(caller, *receiver);
+        if (!call)
+        {
+            processManager.WakeThread(*receiver, caller.getId());
+            processManager.PreemptIfOutranked(core, *receiver, false);
+            return KernelResultStatus::Success;
+        }
+
+        // Wait for the reply and run the server in the caller's place, it is about to do work on its behalf.
+        processManager.BlockThread(core);
+        caller._ipcPhase = IpcPhase::Receiving;
+        caller._ipcPartner = toThreadId;
+        processManager.HandOff(core, *receiver, caller.getId());
+        // Returned if the send times out, the reply replaces it.
+        return KernelResultStatus::Timeout;
+    }
+    if (timeoutTicks == 0) return KernelResultStatus::Timeout;
+
+    processManager.BlockThreadOn(core, receiver->_ipcSenders, timeoutTicks);
+    caller._ipcPhase = call ? IpcPhase::Calling : IpcPhase::Sending;
+    caller._ipcPartner = toThreadId;
+    // Returned if the send times out, the receiver replaces it.
+    return KernelResultStatus::Timeout;
+}
+
+uint32_t
+IpcManager::Receive(uint32_t core, const uint32_t fromThreadId, const uint32_t timeoutTicks)
+{
+    Thread& caller = *processManager.GetRunningThread(core);
+    Thread* const sender = FindSender(caller, fromThreadId);
+    if (sender != nullptr)
+    {
+        Transfer(*sender, caller);
+        if (sender->_ipcPhase == IpcPhase::Calling)
+        {
+            // Stays blocked until the reply, which has no timeout.
+            processManager.MoveToBlockedQueue(*sender);
+            sender->_ipcPhase = IpcPhase::Receiving;
+            sender->_ipcPartner = caller.getId();
+        }
+        else
+        {
+            processManager.WakeThread(*sender, static_cast<uint32_t>(KernelResultStatus::Success));
+            processManager.PreemptIfOutranked(core, *sender, false);
+        }
+        return sender->getId();
+    }
+    if (timeoutTicks == 0) return 0;
+
+    processManager.BlockThread(core, timeoutTicks);
+    caller._ipcPhase = IpcPhase::Receiving;
+    caller._ipcPartner = fromThreadId;
+    // Returned if the receive times out, the sender replaces it.
+    return 0;
+}
+
+KernelResultStatus
+IpcManager::Reply(uint32_t core, const uint32_t toThreadId)
+{
+    Thread& caller = *processManager.GetRunningThread(core);
+    Thread* const client = processManager.FindThread(toThreadId);
+    if ((client == nullptr) || !IsReceivingFrom(*client, caller) || (client->_ipcPartner != caller.getId()))
+    {
+        return KernelResultStatus::Error;
+    }
+
+    Transfer(caller, *client);
+    processManager.WakeThread(*client, static_cast<uint32_t>(KernelResultStatus::Success));
+    processManager.PreemptIfOutranked(core, *client, false);
+    return KernelResultStatus::Success;
+}
+
+uint32_t
+IpcManager::ReplyWait(uint32_t core, const uint32_t toThreadId, const uint32_t timeoutTicks)
+{
+    Thread& caller = *processManager.GetRunningThread(core);
+    Thread* const client = processManager.FindThread(toThreadId);
+    if ((client == nullptr) || !IsReceivingFrom(*client, caller) || (client->_ipcPartner != caller.getId())) return 0;
+
+    // Deliver the reply before receiving overwrites the server's registers, but only wake the client once
+    // it is known whether the server blocks, so the core can switch straight to the client if it does.
+    Transfer(caller, *client);
+    const uint32_t senderId = Receive(core, IPC_ANY_THREAD, timeoutTicks);
+    if (caller._state == ThreadState::Executing)
+    {
+        processManager.WakeThread(*client, static_cast<uint32_t>(KernelResultStatus::Success));
+        processManager.PreemptIfOutranked(core, *client, false);
+    }
+    else
+    {
+        processManager.HandOff(core, *client, static_cast<uint32_t>(KernelResultStatus::Success));
+    }
+    return senderId;
+}
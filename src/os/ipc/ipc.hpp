@@ -0,0 +1,64 @@
+#ifndef _IPC_H
+#define _IPC_H
+
+#include "kernel_result_status.hpp"
+#include "thread.h"
+#include <cstdint>
+
+// Receive from whichever thread sends first.
+#define IPC_ANY_THREAD 0u
+// Words in a message, carried in R4-R11.
+#define IPC_MESSAGE_WORDS 8u
+
+/// @brief Synchronous message passing between threads.
+/// Messages are passed in the callee-saved registers R4-R11, copied straight from the sender's saved registers
+/// to the receiver's, so nothing is buffered in the kernel. Senders block until the receiver takes the message.
+/// A call is a send followed by a receive from the same thread, and when the server is already waiting the
+/// kernel switches straight to it instead of going through the ready queues.
+class IpcManager
+{
+    private:
+        static void Transfer(const Thread& sender, Thread& receiver);
+        /// @return Whether a thread is blocked receiving a message that the sender can deliver.
+        static bool IsReceivingFrom(const Thread& receiver, const Thread& sender);
+        static Thread* FindSender(Thread& receiver, const uint32_t fromThreadId);
+        KernelResultStatus Deliver(uint32_t core, const uint32_t toThreadId, const uint32_t timeoutTicks, const bool call);
+
+    public:
+        IpcManager();
+        IpcManager(const IpcManager&) = delete;
+        IpcManager(IpcManager&&) = delete;
+        ~IpcManager();
+        IpcManager& operator=(const IpcManager&) = delete;
+        IpcManager& operator=(IpcManager&&) = delete;
+
+        /// @brief Send the running thread's message to another thread, blocking until it is received.
+        /// @param timeoutTicks How long to wait for the receiver. 0 doesn't block, WAIT_FOREVER never times out.
+        /// @return Success once received, Timeout if the receiver didn't take it in time, Error if there is no such thread.
+        KernelResultStatus Send(uint32_t core, const uint32_t toThreadId, const uint32_t timeoutTicks)
+        {
+            return Deliver(core, toThreadId, timeoutTicks, false);
+        };
+        /// @brief Send the running thread's message and wait for the receiver's reply, which replaces the message.
+        /// @param timeoutTicks How long to wait for the receiver to take the message. Waiting for the reply never times out.
+        /// @return Success once replied to, otherwise as Send.
+        KernelResultStatus Call(uint32_t core, const uint32_t toThreadId, const uint32_t timeoutTicks)
+        {
+            return Deliver(core, toThreadId, timeoutTicks, true);
+        };
+        /// @brief Receive a message into the running thread's registers, blocking until one is sent.
+        /// @param fromThreadId Only receive from this thread, or IPC_ANY_THREAD.
+        /// @return The sender's thread ID, 0 if nothing was received in time.
+        uint32_t Receive(uint32_t core, const uint32_t fromThreadId, const uint32_t timeoutTicks);
+        /// @brief Send the running thread's message to a thread waiting for its reply, without blocking.
+        /// @return Success, or Error if the thread isn't waiting for a reply from the caller.
+        KernelResultStatus Reply(uint32_t core, const uint32_t toThreadId);
+        /// @brief Reply to a caller, then receive the next message from anyone. The usual server loop.
+        /// If the server blocks, the core switches straight to the caller.
+        /// @return The next sender's thread ID, 0 if nothing was received in time or the reply failed.
+        uint32_t ReplyWait(uint32_t core, const uint32_t toThreadId, const uint32_t timeoutTicks);
+};
+
+extern IpcManager ipcManager;
+
+#endif /* _IPC_H */
@@ -0,0 +1,21 @@
+#include "ipc_api.hpp"
+
+namespace os::ipc
+{
+    // The request ID is only known at run time, so it goes in R12 with an indirect SVC.
+    // The thread and the timeout become params 1 and 2. The message stays in R2, which survives the SVC
+    // and is ignored by the IPC requests.
+    extern "C" __attribute__((naked)) uint32_t
+    IpcRequest(const os::api::ApiRequestId, const uint32_t, IpcMessage&, const uint32_t)
+    {
+        asm volatile(
+            "PUSH   { R4-R11, LR }\n\t"
+            "MOV    R12, R0\n\t"
+            "MOV    R0, R1\n\t"
+            "MOV    R1, R3\n\t"
+            "LDMIA  R2, { R4-R11 }\n\t"
+            "SVC    #0\n\t"
+            "STMIA  R2, { R4-R11 }\n\t"
+            "POP    { R4-R11, PC }\n\t");
+    }
+}
@@ -0,0 +1,116 @@
+#ifndef _IPC_API_H
+#define _IPC_API_H
+
+#include "api_request.hpp"
+#include "ipc.hpp"
+#include "kernel_result_status.hpp"
+#include "libos.hpp"
+#include "region_queue.hpp"
+#include "shared_memory.hpp"
+#include <cstdint>
+
+/* Thread-side calls for IPC.
+ * Synchronous messages travel in R4-R11, so a round trip never touches memory in the kernel.
+ * The message is updated in place with whatever the thread received.
+ * Bulk data travels as whole memory regions through a RegionQueue, which moves them between processes without copying.
+ * Shared memory lets processes exchange data, e.g. through a lock-free ring buffer, without any requests at all.
+ */
+namespace os::ipc
+{
+    class IpcMessage
+    {
+        public:
+            uint32_t Words[IPC_MESSAGE_WORDS];
+    };
+
+    /// @brief Load a message into R4-R11, make an IPC request, then store R4-R11 back into the message.
+    /// @param id One of the Ipc* requests.
+    /// @param threadId The other thread, param 1 of the request.
+    /// @param message Message to send, replaced by the message received.
+    /// @param timeoutTicks Param 2 of the request.
+    /// @return The request's result.
+    extern "C" uint32_t IpcRequest(const os::api::ApiRequestId id, const uint32_t threadId, IpcMessage& message, const uint32_t timeoutTicks);
+
+    inline KernelResultStatus
+    IpcSend(const uint32_t toThreadId, IpcMessage& message, const uint32_t timeoutTicks = WAIT_FOREVER)
+    {
+        return static_cast<KernelResultStatus>(IpcRequest(os::api::ApiRequestId::IpcSend, toThreadId, message, timeoutTicks));
+    }
+
+    /// @brief Send a message and wait for the reply, which replaces it.
+    inline KernelResultStatus
+    IpcCall(const uint32_t toThreadId, IpcMessage& message, const uint32_t timeoutTicks = WAIT_FOREVER)
+    {
+        return static_cast<KernelResultStatus>(IpcRequest(os::api::ApiRequestId::IpcCall, toThreadId, message, timeoutTicks));
+    }
+
+    /// @return The sender's thread ID, 0 if nothing was received in time.
+    inline uint32_t
+    IpcReceive(IpcMessage& message, const uint32_t fromThreadId = IPC_ANY_THREAD, const uint32_t timeoutTicks = WAIT_FOREVER)
+    {
+        return IpcRequest(os::api::ApiRequestId::IpcReceive, fromThreadId, message, timeoutTicks);
+    }
+
+    inline KernelResultStatus
+    IpcReply(const uint32_t toThreadId, IpcMessage& message)
+    {
+        return static_cast<KernelResultStatus>(IpcRequest(os::api::ApiRequestId::IpcReply, toThreadId, message, 0));
+    }
+
+    /// @brief Reply to a caller with the message, then receive the next message into it.
+    /// @return The next sender's thread ID, 0 if nothing was received in time or the reply failed.
+    inline uint32_t
+    IpcReplyWait(const uint32_t toThreadId, IpcMessage& message, const uint32_t timeoutTicks = WAIT_FOREVER)
+    {
+        return IpcRequest(os::api::ApiRequestId::IpcReplyWait, toThreadId, message, timeoutTicks);
+    }
+
+    /// @param depth Regions the queue can hold at once, at most REGION_QUEUE_MAX_DEPTH.
+    /// @return A handle with every right to a new region queue, HANDLE_NONE if it can't be made.
+    inline Handle
+    CreateRegionQueue(const uint32_t depth)
+    {
+        return os::libos::CreateRegionQueue(depth);
+    }
+
+    /// @brief Hand a memory region allocated by the caller's process over to the queue's receiver.
+    /// The caller must not touch the region afterwards, it belongs to the receiving process once sent.
+    inline KernelResultStatus
+    RegionQueueSend(const Handle queue, const void* const regionStart, const uint32_t timeoutTicks = WAIT_FOREVER)
+    {
+        return os::libos::RegionQueueSend(queue, reinterpret_cast<uintptr_t>(regionStart), timeoutTicks);
+    }
+
+    /// @return The region received, now owned by the caller's process. nullptr if none arrived in time.
+    inline void*
+    RegionQueueReceive(const Handle queue, const uint32_t timeoutTicks = WAIT_FOREVER)
+    {
+        return reinterpret_cast<void*>(os::libos::RegionQueueReceive(queue, timeoutTicks));
+    }
+
+    /// @return The size of a region owned by the caller's process, 0 if it doesn't own one starting there.
+    inline size_t
+    GetMemRegionSize(const void* const regionStart)
+    {
+        return os::libos::GetMemRegionSize(reinterpret_cast<uintptr_t>(regionStart));
+    }
+
+    /// @brief Attach the caller's process to the shared memory with a key, creating it if no process has yet.
+    /// @param size Size to create it with, ignored if it already exists.
+    /// @param permissions Must include Read. Only one process at a time can attach with Write.
+    /// @return The shared memory, nullptr if it can't be attached.
+    inline void*
+    SharedMemoryAttach(const uint32_t key, const size_t size, const MemPermisions permissions)
+    {
+        return reinterpret_cast<void*>(os::libos::SharedMemoryAttach(key, size, permissions));
+    }
+
+    /// @brief Detach the caller's process, the memory is freed once no process is attached.
+    inline KernelResultStatus
+    SharedMemoryDetach(const void* const start)
+    {
+        return os::libos::SharedMemoryDetach(reinterpret_cast<uintptr_t>(start));
+    }
+}
+
+#endif /* _IPC_API_H */
@@ -0,0 +1,116 @@
+#include "region_queue.hpp"
+#include "kernel_lock.hpp"
+#include "proc_mgr.h"
+
+RegionQueue::RegionQueue(const uint32_t depth)
+    : KernelObject(),
+      _regions(),
+      _depth(depth == 0 ? 1 : (depth > REGION_QUEUE_MAX_DEPTH ? REGION_QUEUE_MAX_DEPTH : depth)),
+      _head(0),
+      _count(0),
+      _receivers(),
+      _senders()
+{
+}
+
+RegionQueue::~RegionQueue()
+{
+    {
+        // Receivers get nothing, senders keep the region they were sending.
+        KernelLock::Guard guard(schedulerLock);
+        while (!_receivers.empty())
+        {
+            processManager.WakeThread(*_receivers.front(), 0);
+        }
+        while (!_senders.empty())
+        {
+            processManager.WakeThread(*_senders.front(), static_cast<uint32_t>(KernelResultStatus::Error));
+        }
+    }
+    while (_count > 0)
+    {
+        memoryManager.Free(Pop());
+    }
+}
+
+void
+RegionQueue::Push(const MemRegion& region)
+{
+    uint32_t tail = _head + _count;
+    if (tail >= _depth) tail -= _depth;
+    _regions[tail] = region;
+    _count++;
+}
+
+MemRegion
+RegionQueue::Pop()
+{
+    const MemRegion region = _regions[_head];
+    _head = (_head + 1 == _depth) ? 0 : _head + 1;
+    _count--;
+    return region;
+}
+
+KernelResultStatus
+RegionQueue::Send(uint32_t core, const uintptr_t regionStart, const uint32_t timeoutTicks)
+{
+    Thread& sender = *processManager.GetRunningThread(core);
+    Process& process = sender.getProcess();
+    if (process.GetMemRegionSize(regionStart) == 0) return KernelResultStatus::Error;
+
+    Thread* const receiver = _receivers.front();
+    if (receiver != nullptr)
+    {
+        if (!receiver->getProcess().CanAddMemRegion()) return KernelResultStatus::Error;
+        // Nothing is queued if a thread is waiting, give the region straight to it.
+        MemRegion region;
+        process.TakeMemRegion(regionStart, region);
+        receiver->getProcess().AddMemRegion(region);
+        processManager.WakeThread(*receiver, regionStart);
+        processManager.PreemptIfOutranked(core, *receiver, false);
+        return KernelResultStatus::Success;
+    }
+    if (_count < _depth)
+    {
+        MemRegion region;
+        process.TakeMemRegion(regionStart, region);
+        Push(region);
+        return KernelResultStatus::Success;
+    }
+    if (timeoutTicks == 0) return KernelResultStatus::Timeout;
+
+    sender._waitRegion = regionStart;
+    processManager.BlockThreadOn(core, _senders, timeoutTicks);
+    // Returned if the send times out, Receive replaces it once the region is queued.
+    return KernelResultStatus::Timeout;
+}
+
+uintptr_t
+RegionQueue::Receive(uint32_t core, const uint32_t timeoutTicks)
+{
+    Thread& receiver = *processManager.GetRunningThread(core);
+    // The region would have nowhere to go, leave it queued.
+    if (!receiver.getProcess().CanAddMemRegion()) return 0;
+    if (_count == 0)
+    {
+        if (timeoutTicks == 0) return 0;
+        processManager.BlockThreadOn(core, _receivers, timeoutTicks);
+        // Returned if the receive times out, Send replaces it with the region.
+        return 0;
+    }
+
+    const MemRegion region = Pop();
+    receiver.getProcess().AddMemRegion(region);
+
+    // Queue the region of the first sender waiting for space.
+    Thread* const sender = _senders.front();
+    if (sender != nullptr)
+    {
+        MemRegion sent;
+        const bool owned = sender->getProcess().TakeMemRegion(sender->_waitRegion, sent);
+        if (owned) Push(sent);
+        processManager.WakeThread(*sender, static_cast<uint32_t>(owned ? KernelResultStatus::Success : KernelResultStatus::Error));
+        processManager.PreemptIfOutranked(core, *sender, false);
+    }
+    return region.start();
+}
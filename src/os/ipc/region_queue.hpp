@@ -0,0 +1,53 @@
+#ifndef _REGION_QUEUE_H
+#define _REGION_QUEUE_H
+
+#include "kernel_object.hpp"
+#include "kernel_result_status.hpp"
+#include "mem_region.hpp"
+#include "thread.h"
+#include <cstdint>
+
+#define REGION_QUEUE_MAX_DEPTH 8u
+
+/// @brief Queue of memory regions passed from one process to another without copying them.
+/// Sending a region takes it away from the sending process, receiving it gives it to the receiving process,
+/// so only one process owns the data at any time. Threads send and receive through ApiRequestId::RegionQueueSend
+/// and ApiRequestId::RegionQueueReceive, highest priority first.
+class RegionQueue : public KernelObject
+{
+    private:
+        MemRegion _regions[REGION_QUEUE_MAX_DEPTH];
+        uint32_t _depth;
+        uint32_t _head;
+        uint32_t _count;
+        ThreadQueue _receivers;
+        ThreadQueue _senders;
+
+        void Push(const MemRegion& region);
+        MemRegion Pop();
+
+    public:
+        /// @param depth Number of regions that can be queued before senders block, at most REGION_QUEUE_MAX_DEPTH.
+        explicit RegionQueue(const uint32_t depth);
+        RegionQueue(const RegionQueue&) = delete;
+        RegionQueue(RegionQueue&&) = delete;
+        /// @brief Frees any regions still queued.
+        ~RegionQueue();
+        RegionQueue& operator=(const RegionQueue&) = delete;
+        RegionQueue& operator=(RegionQueue&&) = delete;
+
+        /// @brief Hand one of the running thread's process's memory regions over, blocking while the queue is full.
+        /// The region belongs to the sender until it is queued. The calling thread yields if a receiver
+        /// with a higher priority takes it.
+        /// @param regionStart Start address of the region, which must have been allocated as a whole.
+        /// @param timeoutTicks How long to block for. 0 doesn't block, WAIT_FOREVER never times out.
+        /// @return Success once queued, Timeout if the queue stayed full, Error if the process doesn't own the region
+        ///         or the waiting receiver's process can't be given another one.
+        KernelResultStatus Send(uint32_t core, const uintptr_t regionStart, const uint32_t timeoutTicks);
+        /// @brief Take the oldest region, giving it to the running thread's process. Blocks while the queue is empty.
+        /// @return Start address of the region, 0 if none arrived in time or the process can't be given another one.
+        uintptr_t Receive(uint32_t core, const uint32_t timeoutTicks);
+        uint32_t GetCount() const { return _count; };
+};
+
+#endif /* _REGION_QUEUE_H */
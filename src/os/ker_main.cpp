@@ -1,13 +1,22 @@
 #include "alloc.h"
+#include "async_manager.hpp"
+#include "critical_section.h"
 #include "drivers.h"
+#include "interrupt_priorities.h"
 #include "kernel_api.hpp"
+#include "kernel_data.hpp"
+#include "libos.hpp"
 #include "mem_mgr.h"
 #include "proc_mgr.h"
 #include "savedRegisters.hpp"
 #include "static_circular_buffer.h"
 #include "stm32_rtc.h"
+#include "sync_api.hpp"
 #include "sys_ctl_block.h"
+#include "work_queue.hpp"
 
+using namespace os::api;
+using namespace os::sync;
 using namespace os::utils::static_buffer;
 
 static MemRegion
@@ -19,6 +28,7 @@ AllocateMem(const size_t numBytes)
 static void
 OnAllocateComplete(const MemRegion& memRegion)
 {
+    // The kernel process is never torn down, so its heap is still usable if the region can't be recorded.
     processManager.GetKernelProcess()->AddMemRegion(memRegion);
 }
 
@@ -29,25 +39,34 @@ static const char threeText[] = "3";
 static const char fourText[] = "4";
 static const char fiveText[] = "5";
 static const char helloText[] = "hello ";
+// Semaphore that keeps each thread's messages together on the USART, as each thread's process names it.
+// Set before either process starts running.
+static Handle usartLock1;
+static Handle usartLock2;
+
+static void
+sendLocked(const Handle usartLock, const char* firstText, const uint8_t firstLength, const char* secondText, const uint8_t secondLength)
+{
+    SemaphoreWait(usartLock);
+    usart_send_string(USART1, firstText, firstLength);
+    usart_send_string(USART1, secondText, secondLength);
+    SemaphorePost(usartLock);
+}
+
 static void
 thread1(void)
 {
     while (true)
     {
-        usart_send_string(USART1, helloText, sizeof(helloText));
-        usart_send_string(USART1, oneText, sizeof(oneText));
+        sendLocked(usartLock1, helloText, sizeof(helloText), oneText, sizeof(oneText));
         asm("WFI");
-        usart_send_string(USART1, helloText, sizeof(helloText));
-        usart_send_string(USART1, twoText, sizeof(twoText));
+        sendLocked(usartLock1, helloText, sizeof(helloText), twoText, sizeof(twoText));
         asm("WFI");
-        usart_send_string(USART1, helloText, sizeof(helloText));
-        usart_send_string(USART1, threeText, sizeof(threeText));
+        sendLocked(usartLock1, helloText, sizeof(helloText), threeText, sizeof(threeText));
         asm("WFI");
-        usart_send_string(USART1, helloText, sizeof(helloText));
-        usart_send_string(USART1, fourText, sizeof(fourText));
+        sendLocked(usartLock1, helloText, sizeof(helloText), fourText, sizeof(fourText));
         asm("WFI");
-        usart_send_string(USART1, helloText, sizeof(helloText));
-        usart_send_string(USART1, fiveText, sizeof(fiveText));
+        sendLocked(usartLock1, helloText, sizeof(helloText), fiveText, sizeof(fiveText));
         asm("WFI");
     }
 }
@@ -58,51 +77,51 @@ thread2(void)
 {
     while (true)
     {
-        usart_send_string(USART1, worldText, sizeof(worldText));
-        usart_send_string(USART1, oneText, sizeof(oneText));
+        sendLocked(usartLock2, worldText, sizeof(worldText), oneText, sizeof(oneText));
         asm("WFI");
-        usart_send_string(USART1, worldText, sizeof(worldText));
-        usart_send_string(USART1, twoText, sizeof(twoText));
+        sendLocked(usartLock2, worldText, sizeof(worldText), twoText, sizeof(twoText));
         asm("WFI");
-        usart_send_string(USART1, worldText, sizeof(worldText));
-        usart_send_string(USART1, threeText, sizeof(threeText));
+        sendLocked(usartLock2, worldText, sizeof(worldText), threeText, sizeof(threeText));
         asm("WFI");
-        usart_send_string(USART1, worldText, sizeof(worldText));
-        usart_send_string(USART1, fourText, sizeof(fourText));
+        sendLocked(usartLock2, worldText, sizeof(worldText), fourText, sizeof(fourText));
         asm("WFI");
-        usart_send_string(USART1, worldText, sizeof(worldText));
-        usart_send_string(USART1, fiveText, sizeof(fiveText));
+        sendLocked(usartLock2, worldText, sizeof(worldText), fiveText, sizeof(fiveText));
         asm("WFI");
     }
 }
 
 extern Thread* schedulerThread;
 extern Thread* volatile runningThread;
-extern Thread* volatile otherThread;
 extern SavedRegisters* volatile runningThreadSavedRegisters;
 
 extern void
 threadScheduler(void);
 
 static void
-startExecution(Thread* scheduler, Thread* thread1, Thread* thread2)
+startExecution(Thread* scheduler)
 {
     schedulerThread = scheduler;
-    runningThread = thread1;
-    otherThread = thread2;
-    runningThreadSavedRegisters = const_cast<SavedRegisters*>(thread1->GetSavedRegisters());
+    Thread* const firstThread = processManager.ScheduleNextThread(0);
+    runningThread = firstThread;
+    runningThreadSavedRegisters = const_cast<SavedRegisters*>(firstThread->GetSavedRegisters());
+}
+
+/// @brief Give both demo processes a handle to one semaphore guarding the USART.
+static void
+createUsartLock(Process* const first, Process* const second)
+{
+    if ((first == nullptr) || (second == nullptr)) return;
+    Semaphore* const usartLock = new Semaphore(1, 1);
+    if (usartLock == nullptr) return;
+    usartLock1 = first->GetHandles().Insert(*usartLock, HandleRights::All);
+    usartLock2 = second->GetHandles().Insert(*usartLock, HandleRights::All);
 }
 
 static void
 disableInterrupts(void)
 {
-    asm volatile(
-        "MRS  R0, FAULTMASK\n\t"
-        "ORR  R0, R0, #0x1\n\t"
-        "MSR  FAULTMASK, R0\n\t"
-        :
-        :
-        : "r0");
+    // Only interrupts that use the kernel need to wait for it to be set up.
+    enter_critical_section();
 }
 
 static void
@@ -110,13 +129,8 @@ enableInterrupts(void)
 {
     SYS_CTL->clear_pending_pendsv();
     SYS_CTL->clear_pending_systick();
-    asm volatile(
-        "MRS  R0, FAULTMASK\n\t"
-        "AND  R0, R0, %0\n\t"
-        "MSR  FAULTMASK, R0\n\t"
-        :
-        : "i"(~0x1u)
-        : "r0");
+    // BASEPRI is 0 out of reset.
+    exit_critical_section(0);
 }
 // TEST END
 
@@ -144,16 +158,21 @@ ker_main(void)
           - Will need to allocate stack storage
     */
     disableInterrupts();
+    interrupt_priorities_init();
     usart_driver_init();
     usart_send_string(USART1, "hello world\n", sizeof("hello world\n"));
 
     memoryManager.Initialize();
+    kernelData.Initialize();
     kernelApi.ApiEntry = threadScheduler; // temp
     processManager.Initialize(memoryManager, kernelApi);
+    workQueue.Initialize(processManager, memoryManager);
+    asyncManager.Initialize(processManager, memoryManager);
     alloc_init(AllocateMem, OnAllocateComplete);
-    auto process1 = processManager.CreateProcess(thread1);
-    auto process2 = processManager.CreateProcess(thread2);
-    startExecution(processManager.GetKernelProcess()->GetMainThread(), process1->GetMainThread(), process2->GetMainThread());
+    Process* const process1 = processManager.CreateProcess(thread1);
+    Process* const process2 = processManager.CreateProcess(thread2);
+    createUsartLock(process1, process2);
+    startExecution(processManager.GetKernelProcess()->GetMainThread());
     enableInterrupts();
     SYS_CTL->enable_sys_tick();
     SYS_CTL->set_pending_pendsv();
@@ -6,6 +6,8 @@ enum class KernelResultStatus
     Uknown,
     Success,
     Error,
+    /// @brief A wait ended because its timeout expired.
+    Timeout,
 };
 
 #endif /* _KERNEL_REQUEST_STATUS_H */
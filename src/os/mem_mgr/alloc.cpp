@@ -1,4 +1,5 @@
 #include "alloc.h"
+#include "kernel_lock.hpp"
 #include "mem_mgr.h"
 #include <new>
 /*
@@ -709,17 +710,19 @@ alloc_init(AllocFunc alloc_func, AllocCompleteCallback callback)
 
 /* The _ker_* functions assume the caller enforces the restrictions
  * e.g. aligned sizes, aligned pointers
+ * Only the free list itself is locked, zeroing and copying can be preempted.
  */
 void*
 _ker_malloc(const size_t req_size)
 {
+    KernelLock::Guard guard(memoryLock);
     return free_list_start.malloc(req_size);
 }
 
 void*
 _ker_calloc(const size_t req_size)
 {
-    size_t* p = static_cast<size_t*>(free_list_start.malloc(req_size));
+    size_t* p = static_cast<size_t*>(_ker_malloc(req_size));
     if (p == nullptr)
     {
         return nullptr;
@@ -738,17 +741,22 @@ _ker_calloc(const size_t req_size)
 void
 _ker_free(const size_t req_size, void* const p)
 {
+    KernelLock::Guard guard(memoryLock);
     free_list_start.free(req_size, p);
 }
 
 void*
 _ker_realloc(const size_t old_size, const size_t new_size, void* const p)
 {
-    size_t* ret = static_cast<size_t*>(free_list_start.resize(old_size, new_size, static_cast<void*>(p)));
+    size_t* ret;
+    {
+        KernelLock::Guard guard(memoryLock);
+        ret = static_cast<size_t*>(free_list_start.resize(old_size, new_size, static_cast<void*>(p)));
+    }
     if (ret == nullptr)
     {
         /* Need to allocate new block */
-        ret = static_cast<size_t*>(free_list_start.malloc(new_size));
+        ret = static_cast<size_t*>(_ker_malloc(new_size));
         if (ret == nullptr)
         {
             /* Couldn't allocate more mem */
@@ -775,7 +783,7 @@ _ker_realloc(const size_t old_size, const size_t new_size, void* const p)
         }
 
         /* Free old mem */
-        free_list_start.free(old_size, static_cast<void*>(p));
+        _ker_free(old_size, static_cast<void*>(p));
 
         return static_cast<void*>(r);
     }
@@ -1,5 +1,6 @@
 #include "mem_mgr.h"
 #include "chip_common.h"
+#include "kernel_lock.hpp"
 #include "mpu.h"
 
 /* What mem_mgr needs to do:
@@ -67,6 +68,7 @@ MemoryManager::Allocate(const size_t numBytes)
     const size_t roundedUp = roundedDown + PAGE_SIZE;
     const size_t numPages = roundedUp / PAGE_SIZE;
 
+    KernelLock::Guard guard(memoryLock);
     const void* const startAddr = _pageList.allocatePages(numPages);
     const uintptr_t startAddrInt = reinterpret_cast<uintptr_t>(startAddr);
     const size_t sizeAllocated = numPages * PAGE_SIZE;
@@ -81,5 +83,6 @@ MemoryManager::Free(const MemRegion& memRegion)
 {
     void* const startAddr = reinterpret_cast<void*>(memRegion.start());
     const size_t numPages = memRegion.size() / PAGE_SIZE;
+    KernelLock::Guard guard(memoryLock);
     _pageList.freePages(numPages, startAddr);
 }
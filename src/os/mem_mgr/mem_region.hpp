@@ -13,6 +13,19 @@ enum class MemPermisions : uint8_t
     Execute = 0x4,
 };
 
+constexpr MemPermisions
+operator|(const MemPermisions left, const MemPermisions right)
+{
+    return static_cast<MemPermisions>(static_cast<uint8_t>(left) | static_cast<uint8_t>(right));
+}
+
+/// @return Whether a set of permissions includes all of the wanted ones.
+inline bool
+HasPermissions(const MemPermisions permissions, const MemPermisions wanted)
+{
+    return (static_cast<uint8_t>(permissions) & static_cast<uint8_t>(wanted)) == static_cast<uint8_t>(wanted);
+}
+
 /// @brief Represents a region in memory to be used by a process.
 class MemRegion
 {
@@ -0,0 +1,145 @@
+#ifndef _REGION_MAP_H
+#define _REGION_MAP_H
+
+#include "mem_region.hpp"
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Fixed-capacity set of non-overlapping memory regions, kept in an array sorted by start address.
+/// Finding the region around an address is a binary search over contiguous memory, with no pointer chasing.
+/// Regions keep the bounds they were added with, since each one is taken back or freed on its own,
+/// but a range running from one region into the next adjacent one is still covered, see Covers.
+/// @tparam TCapacity Maximum number of regions at once.
+template <std::size_t TCapacity>
+class RegionMap
+{
+        static_assert(TCapacity > 0, "A map must be able to hold a region");
+
+    private:
+        MemRegion _regions[TCapacity];
+        std::size_t _count;
+
+        /// @return Index of the first region starting after an address, i.e. where a region starting there would go.
+        std::size_t UpperBound(const uintptr_t address) const
+        {
+            std::size_t low = 0;
+            std::size_t high = _count;
+            while (low < high)
+            {
+                const std::size_t middle = (low + high) / 2;
+                if (_regions[middle].start() <= address)
+                {
+                    low = middle + 1;
+                }
+                else
+                {
+                    high = middle;
+                }
+            }
+            return low;
+        }
+
+        /// @return Index of the region starting at an address, TCapacity if there is none.
+        std::size_t IndexOf(const uintptr_t start) const
+        {
+            const std::size_t after = UpperBound(start);
+            if ((after == 0) || (_regions[after - 1].start() != start)) return TCapacity;
+            return after - 1;
+        }
+
+    public:
+        RegionMap()
+            : _regions(),
+              _count(0)
+        {
+        }
+        RegionMap(const RegionMap&) = default;
+        RegionMap(RegionMap&&) = default;
+        ~RegionMap()
+        {
+            // Regions aren't owned, nothing to do.
+        }
+        RegionMap& operator=(const RegionMap&) = default;
+        RegionMap& operator=(RegionMap&&) = default;
+
+        bool IsEmpty() const { return _count == 0; };
+        bool IsFull() const { return _count == TCapacity; };
+        /// @brief The region with the lowest address. Only valid while the map isn't empty.
+        const MemRegion& First() const { return _regions[0]; };
+
+        /// @return Whether the region was added, false if the map is full or it overlaps one already there.
+        bool Add(const MemRegion& region)
+        {
+            if ((_count == TCapacity) || (region.size() == 0)) return false;
+
+            const std::size_t index = UpperBound(region.start());
+            if ((index > 0) && (_regions[index - 1].getEnd() >= region.start())) return false;
+            if ((index < _count) && (region.getEnd() >= _regions[index].start())) return false;
+
+            for (std::size_t i = _count; i > index; i--)
+            {
+                _regions[i] = _regions[i - 1];
+            }
+            _regions[index] = region;
+            _count++;
+            return true;
+        }
+
+        /// @brief Remove the region starting at an address.
+        /// @param region Set to the region removed.
+        /// @return Whether the map had a region starting there.
+        bool Take(const uintptr_t start, MemRegion& region)
+        {
+            const std::size_t index = IndexOf(start);
+            if (index == TCapacity) return false;
+
+            region = _regions[index];
+            _count--;
+            for (std::size_t i = index; i < _count; i++)
+            {
+                _regions[i] = _regions[i + 1];
+            }
+            return true;
+        }
+
+        /// @return The region starting at an address, nullptr if there is none.
+        const MemRegion* Find(const uintptr_t start) const
+        {
+            const std::size_t index = IndexOf(start);
+            return (index == TCapacity) ? nullptr : &_regions[index];
+        }
+
+        /// @return Whether every byte of a range is in the map's regions, each with at least the wanted permissions.
+        bool Covers(const uintptr_t start, const std::size_t length, const MemPermisions wanted) const
+        {
+            if (length == 0) return true;
+            const uintptr_t last = start + length - 1;
+            if (last < start) return false;
+
+            std::size_t index = UpperBound(start);
+            if (index == 0) return false;
+            index--;
+            if (_regions[index].getEnd() < start) return false;
+            while (true)
+            {
+                const MemRegion& region = _regions[index];
+                if (!HasPermissions(region.perms(), wanted)) return false;
+                if (region.getEnd() >= last) return true;
+                // Carry on into the next region only if it starts right where this one ends.
+                index++;
+                if ((index == _count) || (_regions[index].start() != (region.getEnd() + 1))) return false;
+            }
+        }
+
+        /// @brief Call a function with each region, in address order.
+        template <typename Function>
+        void ForEach(Function function) const
+        {
+            for (std::size_t i = 0; i < _count; i++)
+            {
+                function(_regions[i]);
+            }
+        }
+};
+
+#endif /* _REGION_MAP_H */
@@ -0,0 +1,103 @@
+#include "shared_memory.hpp"
+#include "mem_mgr.h"
+#include "process.h"
+
+SharedMemoryManager sharedMemoryManager;
+
+SharedMemoryManager::SharedMemoryManager()
+    : _objects()
+{
+}
+
+SharedMemoryManager::~SharedMemoryManager()
+{
+    // Intentionally do nothing.
+}
+
+SharedMemoryObject*
+SharedMemoryManager::FindByKey(const uint32_t key)
+{
+    for (SharedMemoryObject& object : _objects)
+    {
+        if ((object.References > 0) && (object.Key == key)) return &object;
+    }
+    return nullptr;
+}
+
+SharedMemoryObject*
+SharedMemoryManager::FindByStart(const uintptr_t start)
+{
+    for (SharedMemoryObject& object : _objects)
+    {
+        if ((object.References > 0) && (object.Region.start() == start)) return &object;
+    }
+    return nullptr;
+}
+
+uintptr_t
+SharedMemoryManager::Attach(Process& process, const uint32_t key, const size_t size, const MemPermisions permissions)
+{
+    if ((key == 0) || !HasPermissions(permissions, MemPermisions::Read)) return 0;
+    const bool writer = HasPermissions(permissions, MemPermisions::Write);
+
+    SharedMemoryObject* object = FindByKey(key);
+    if (object == nullptr)
+    {
+        if (size == 0) return 0;
+        for (SharedMemoryObject& candidate : _objects)
+        {
+            if (candidate.References == 0)
+            {
+                object = &candidate;
+                break;
+            }
+        }
+        if (object == nullptr) return 0;
+
+        const MemRegion region = memoryManager.Allocate(size);
+        if (region.start() == 0) return 0;
+        object->Key = key;
+        object->Region = region;
+        object->WriterProcessId = 0;
+    }
+    else
+    {
+        if (process.HasSharedRegion(object->Region.start())) return 0;
+        if (writer && (object->WriterProcessId != 0)) return 0;
+    }
+
+    if (!process.AddSharedRegion(MemRegion{object->Region.start(), object->Region.size(), permissions}))
+    {
+        // Only just created, nobody else can be attached.
+        if (object->References == 0)
+        {
+            memoryManager.Free(object->Region);
+            object->Region = MemRegion{};
+            object->Key = 0;
+        }
+        return 0;
+    }
+    object->References++;
+    if (writer) object->WriterProcessId = process.GetId();
+    return object->Region.start();
+}
+
+KernelResultStatus
+SharedMemoryManager::Detach(Process& process, const uintptr_t start)
+{
+    MemRegion attached;
+    if (!process.TakeSharedRegion(start, attached)) return KernelResultStatus::Error;
+
+    SharedMemoryObject* const object = FindByStart(start);
+    if (object == nullptr) return KernelResultStatus::Error;
+    if (object->WriterProcessId == process.GetId()) object->WriterProcessId = 0;
+
+    object->References--;
+    if (object->References == 0)
+    {
+        memoryManager.Free(object->Region);
+        object->Region = MemRegion{};
+        object->Key = 0;
+    }
+    return KernelResultStatus::Success;
+}
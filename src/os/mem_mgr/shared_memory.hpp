@@ -0,0 +1,65 @@
+#ifndef _SHARED_MEMORY_H
+#define _SHARED_MEMORY_H
+
+#include "kernel_result_status.hpp"
+#include "mem_region.hpp"
+#include <cstddef>
+#include <cstdint>
+
+#define MAX_SHARED_MEMORY_OBJECTS 8u
+
+class Process;
+
+/// @brief Kernel-allocated memory attached to several processes at once.
+class SharedMemoryObject
+{
+    public:
+        uint32_t Key;
+        MemRegion Region;
+        /// @brief Number of processes attached, the memory is freed when the last one detaches.
+        uint32_t References;
+        /// @brief The process attached with write permission, 0 if none is.
+        uint32_t WriterProcessId;
+
+        SharedMemoryObject()
+            : Key(0),
+              Region(),
+              References(0),
+              WriterProcessId(0)
+        {
+        }
+};
+
+/// @brief Named shared memory, for passing data between processes without going through the kernel.
+/// Each process attaches with its own permissions, and only one process at a time can attach with write permission.
+class SharedMemoryManager
+{
+    private:
+        SharedMemoryObject _objects[MAX_SHARED_MEMORY_OBJECTS];
+
+        SharedMemoryObject* FindByKey(const uint32_t key);
+        SharedMemoryObject* FindByStart(const uintptr_t start);
+
+    public:
+        SharedMemoryManager();
+        SharedMemoryManager(const SharedMemoryManager&) = delete;
+        SharedMemoryManager(SharedMemoryManager&&) = delete;
+        ~SharedMemoryManager();
+        SharedMemoryManager& operator=(const SharedMemoryManager&) = delete;
+        SharedMemoryManager& operator=(SharedMemoryManager&&) = delete;
+
+        /// @brief Attach a process to shared memory, creating it on first use.
+        /// @param key Name of the shared memory, any nonzero value agreed on by the processes sharing it.
+        /// @param size Size to create it with, rounded up to whole pages. Ignored if it already exists.
+        /// @param permissions Must include Read. Write is refused while another process has it.
+        /// @return Start address of the shared memory, 0 if it can't be attached.
+        uintptr_t Attach(Process& process, const uint32_t key, const size_t size, const MemPermisions permissions);
+        /// @brief Detach a process from shared memory, freeing it if no other process is attached.
+        /// @param start Start address returned by Attach.
+        /// @return Error if the process isn't attached to shared memory starting at that address.
+        KernelResultStatus Detach(Process& process, const uintptr_t start);
+};
+
+extern SharedMemoryManager sharedMemoryManager;
+
+#endif /* _SHARED_MEMORY_H */
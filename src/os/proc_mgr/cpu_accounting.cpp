@@ -0,0 +1,139 @@
+#include "cpu_accounting.hpp"
+#include "critical_section.h"
+#include "format.h"
+#include "proc_mgr.h"
+#include "usart_driver.h"
+
+using namespace os::utils::format;
+
+#define REPORT_LINE_LENGTH 64
+// Largest total that can be multiplied by 1000 without overflowing 32 bits.
+#define PERMILLE_MAX_TOTAL 0x3fffffu
+
+CpuAccounting cpuAccounting;
+
+/// @brief Share of the total in tenths of a percent, without 64-bit division.
+static uint32_t
+GetPermille(uint64_t cycles, uint64_t totalCycles)
+{
+    while (totalCycles > PERMILLE_MAX_TOTAL)
+    {
+        totalCycles >>= 1;
+        cycles >>= 1;
+    }
+    if (totalCycles == 0) return 0;
+    return (static_cast<uint32_t>(cycles) * 1000u) / static_cast<uint32_t>(totalCycles);
+}
+
+static size_t
+FormatUsageColumns(char* const line, size_t length, const uint64_t cycles, const uint64_t totalCycles)
+{
+    const uint32_t permille = GetPermille(cycles, totalCycles);
+    length += FormatUnsigned(line + length, REPORT_LINE_LENGTH - length, cycles, 16);
+    length += FormatUnsigned(line + length, REPORT_LINE_LENGTH - length, permille / 10, 4);
+    length += FormatString(line + length, REPORT_LINE_LENGTH - length, ".", 1);
+    length += FormatUnsigned(line + length, REPORT_LINE_LENGTH - length, permille % 10, 1);
+    return length;
+}
+
+CpuAccounting::CpuAccounting()
+    : _lastSwitchCycles(),
+      _kernelCycles(0),
+      _irqDepth(),
+      _irqEntryCycles(),
+      _irqCyclesSinceSwitch(),
+      _interruptCycles(0)
+{
+}
+
+CpuAccounting::~CpuAccounting()
+{
+    // Intentionally do nothing.
+}
+
+uint32_t
+CpuAccounting::TakeCyclesSinceSwitch(const uint32_t core, const uint32_t cycles)
+{
+    // Device IRQ handlers can preempt the kernel code calling this, hold them off while taking their cycles.
+    CriticalSection critical;
+    // Unsigned subtraction handles the counter wrapping, as long as a thread doesn't run for a whole wrap period.
+    const uint32_t elapsed = cycles - _lastSwitchCycles[core];
+    // A handler that ran after the cycle count was read is taken here too, it must not make the rest negative.
+    const uint32_t irqCycles = (_irqCyclesSinceSwitch[core] < elapsed) ? _irqCyclesSinceSwitch[core] : elapsed;
+    _irqCyclesSinceSwitch[core] = 0;
+    _interruptCycles += irqCycles;
+    _lastSwitchCycles[core] = cycles;
+    return elapsed - irqCycles;
+}
+
+void
+CpuAccounting::ThreadSwitchedOut(const uint32_t core, Thread& thread, const uint32_t cycles)
+{
+    thread.GetCpuUsage().Cycles += TakeCyclesSinceSwitch(core, cycles);
+}
+
+void
+CpuAccounting::ThreadSwitchedIn(const uint32_t core, const uint32_t cycles)
+{
+    _kernelCycles += TakeCyclesSinceSwitch(core, cycles);
+}
+
+void
+CpuAccounting::IrqEntered(const uint32_t core, const uint32_t cycles)
+{
+    if (_irqDepth[core]++ == 0) _irqEntryCycles[core] = cycles;
+}
+
+void
+CpuAccounting::IrqExited(const uint32_t core, const uint32_t cycles)
+{
+    if (--_irqDepth[core] == 0) _irqCyclesSinceSwitch[core] += cycles - _irqEntryCycles[core];
+}
+
+void
+CpuAccounting::Report(const usart_t usart) const
+{
+    static const char header[] = "  TID  PID          CYCLES  CPU%    VOL  INVOL\n";
+    static CpuUsageEntry entries[CPU_USAGE_REPORT_MAX_THREADS];
+    size_t numEntries;
+    uint64_t kernelCycles;
+    uint64_t interruptCycles;
+    {
+        // May run from the async worker, only the slow output can be preempted.
+        CriticalSection critical;
+        numEntries = processManager.GetCpuUsage(entries, CPU_USAGE_REPORT_MAX_THREADS);
+        kernelCycles = _kernelCycles;
+        interruptCycles = _interruptCycles;
+    }
+
+    uint64_t totalCycles = kernelCycles + interruptCycles;
+    for (size_t i = 0; i < numEntries; i++)
+    {
+        totalCycles += entries[i].Usage.Cycles;
+    }
+
+    char line[REPORT_LINE_LENGTH];
+    usart_send_string(usart, header, sizeof(header) - 1);
+    for (size_t i = 0; i < numEntries; i++)
+    {
+        const CpuUsageEntry& entry = entries[i];
+        size_t length = 0;
+        length += FormatUnsigned(line + length, REPORT_LINE_LENGTH - length, entry.ThreadId, 5);
+        length += FormatUnsigned(line + length, REPORT_LINE_LENGTH - length, entry.ProcessId, 5);
+        length = FormatUsageColumns(line, length, entry.Usage.Cycles, totalCycles);
+        length += FormatUnsigned(line + length, REPORT_LINE_LENGTH - length, entry.Usage.VoluntarySwitches, 7);
+        length += FormatUnsigned(line + length, REPORT_LINE_LENGTH - length, entry.Usage.InvoluntarySwitches, 7);
+        length += FormatString(line + length, REPORT_LINE_LENGTH - length, "\n", 1);
+        usart_send_string(usart, line, static_cast<uint8_t>(length));
+    }
+
+    size_t length = FormatString(line, REPORT_LINE_LENGTH, "kernel", 10);
+    length = FormatUsageColumns(line, length, kernelCycles, totalCycles);
+    length += FormatString(line + length, REPORT_LINE_LENGTH - length, "\n", 1);
+    usart_send_string(usart, line, static_cast<uint8_t>(length));
+
+    length = FormatString(line, REPORT_LINE_LENGTH, "ISR", 10);
+    length = FormatUsageColumns(line, length, interruptCycles, totalCycles);
+    length += FormatString(line + length, REPORT_LINE_LENGTH - length, "\n", 1);
+    usart_send_string(usart, line, static_cast<uint8_t>(length));
+}
@@ -0,0 +1,70 @@
+#ifndef _CPU_ACCOUNTING_H
+#define _CPU_ACCOUNTING_H
+
+#include "cpu.h"
+#include "stm32_usart.h"
+#include "thread.h"
+#include <cstdint>
+
+#define CPU_USAGE_REPORT_MAX_THREADS 16
+
+/// @brief Splits CPU time between threads, the kernel and device interrupts, using cycle counts taken on kernel
+/// entry and exit and around device IRQ handlers.
+/// @remark Only IRQs that may use the kernel are timed, more urgent ones are charged to whatever they interrupted.
+class CpuAccounting
+{
+    private:
+        /// @brief Cycle count of the last switch into or out of the kernel on each core.
+        uint32_t _lastSwitchCycles[NUM_CPUS];
+        /// @brief Cycles spent in the kernel and its exception handlers.
+        uint64_t _kernelCycles;
+        /// @brief Number of device IRQ handlers running on each core, only the outermost one is timed.
+        uint32_t _irqDepth[NUM_CPUS];
+        /// @brief Cycle count when the outermost device IRQ handler was entered on each core.
+        uint32_t _irqEntryCycles[NUM_CPUS];
+        /// @brief Cycles spent in device IRQ handlers on each core since the last switch into or out of the kernel.
+        uint32_t _irqCyclesSinceSwitch[NUM_CPUS];
+        /// @brief Cycles spent in device IRQ handlers.
+        uint64_t _interruptCycles;
+
+        /// @brief Moves the device IRQ cycles since the last switch to the IRQ total.
+        /// @return The rest of the cycles since the last switch, for the caller to charge.
+        uint32_t TakeCyclesSinceSwitch(const uint32_t core, const uint32_t cycles);
+
+    public:
+        CpuAccounting();
+        CpuAccounting(const CpuAccounting&) = delete;
+        CpuAccounting(CpuAccounting&&) = delete;
+        ~CpuAccounting();
+        CpuAccounting& operator=(const CpuAccounting&) = delete;
+        CpuAccounting& operator=(CpuAccounting&&) = delete;
+
+        /// @brief Charges the cycles since a thread was switched in to it, less device IRQ handlers.
+        /// Called on entry to the kernel.
+        /// @param core The core the thread was running on.
+        /// @param thread The thread that was running.
+        /// @param cycles Cycle count at kernel entry.
+        void ThreadSwitchedOut(const uint32_t core, Thread& thread, const uint32_t cycles);
+        /// @brief Charges the cycles since kernel entry to the kernel, less device IRQ handlers.
+        /// Called right before returning to a thread.
+        /// @param core The core the thread is about to run on.
+        /// @param cycles Cycle count at kernel exit.
+        void ThreadSwitchedIn(const uint32_t core, const uint32_t cycles);
+        /// @brief Starts timing a device IRQ handler. Called with interrupts held off.
+        /// @param core The core taking the IRQ.
+        /// @param cycles Cycle count at handler entry.
+        void IrqEntered(const uint32_t core, const uint32_t cycles);
+        /// @brief Stops timing a device IRQ handler. Called with interrupts held off.
+        /// @param core The core taking the IRQ.
+        /// @param cycles Cycle count at handler exit.
+        void IrqExited(const uint32_t core, const uint32_t cycles);
+        uint64_t GetKernelCycles() const { return _kernelCycles; };
+        uint64_t GetInterruptCycles() const { return _interruptCycles; };
+
+        /// @brief Writes a top-style table of CPU usage per thread.
+        void Report(const usart_t usart) const;
+};
+
+extern CpuAccounting cpuAccounting;
+
+#endif /* _CPU_ACCOUNTING_H */
@@ -0,0 +1,35 @@
+#ifndef _CPU_QUOTA_H
+#define _CPU_QUOTA_H
+
+#include <cstdint>
+
+/// @brief Limits how much CPU time all threads of a process can use per period. Times are in ticks.
+class CpuQuota
+{
+    public:
+        /// @brief Ticks the process may run for each period. 0 means unlimited.
+        uint32_t Budget;
+        uint32_t Period;
+        /// @brief Ticks left in the current period.
+        uint32_t Remaining;
+        /// @brief Tick at which the budget is next refilled.
+        uint32_t NextReplenish;
+        /// @brief Whether the process ran out of budget and its threads are held off the ready queues.
+        bool Throttled;
+        /// @brief Number of periods in which the process ran out of budget.
+        uint32_t ThrottleCount;
+
+        CpuQuota()
+            : Budget(0),
+              Period(0),
+              Remaining(0),
+              NextReplenish(0),
+              Throttled(false),
+              ThrottleCount(0)
+        {
+        }
+
+        bool IsLimited() const { return Budget != 0; };
+};
+
+#endif /* _CPU_QUOTA_H */
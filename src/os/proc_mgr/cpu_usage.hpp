@@ -0,0 +1,41 @@
+#ifndef _CPU_USAGE_H
+#define _CPU_USAGE_H
+
+#include <cstdint>
+
+/// @brief CPU time used by a single thread, updated on every context switch.
+class ThreadCpuUsage
+{
+    public:
+        /// @brief Cycles spent running the thread, measured with the DWT cycle counter.
+        uint64_t Cycles;
+        /// @brief Number of times the thread gave up the CPU by blocking or sleeping.
+        uint32_t VoluntarySwitches;
+        /// @brief Number of times the thread was preempted.
+        uint32_t InvoluntarySwitches;
+
+        ThreadCpuUsage()
+            : Cycles(0),
+              VoluntarySwitches(0),
+              InvoluntarySwitches(0)
+        {
+        }
+};
+
+/// @brief CPU usage of one thread, as reported to user space by the kernel API.
+class CpuUsageEntry
+{
+    public:
+        uint32_t ThreadId;
+        uint32_t ProcessId;
+        ThreadCpuUsage Usage;
+
+        CpuUsageEntry()
+            : ThreadId(0),
+              ProcessId(0),
+              Usage()
+        {
+        }
+};
+
+#endif /* _CPU_USAGE_H */
@@ -0,0 +1,52 @@
+#ifndef _DEADLINE_H
+#define _DEADLINE_H
+
+#include <cstdint>
+
+/// @brief Timing declared by a periodic real-time thread. All values are in ticks.
+class DeadlineParameters
+{
+    public:
+        /// @brief Time between releases of consecutive jobs.
+        uint32_t Period;
+        /// @brief CPU time each job may use. Enforced every tick.
+        uint32_t Budget;
+        /// @brief Time after its release by which a job must complete. Must be between Budget and Period.
+        uint32_t RelativeDeadline;
+
+        DeadlineParameters()
+            : Period(0),
+              Budget(0),
+              RelativeDeadline(0)
+        {
+        }
+};
+
+/// @brief State of the current job of a thread in the deadline scheduling class.
+class DeadlineState
+{
+    public:
+        DeadlineParameters Parameters;
+        /// @brief Tick by which the current job must complete. Threads are run in order of this.
+        uint32_t AbsoluteDeadline;
+        /// @brief Tick at which the next job is released.
+        uint32_t NextRelease;
+        /// @brief Ticks of budget left for the current job.
+        uint32_t RemainingBudget;
+        /// @brief Number of jobs that did not complete by their deadline.
+        uint32_t Misses;
+        /// @brief Whether the thread has finished its current job and is waiting for the next release.
+        bool JobComplete;
+
+        DeadlineState()
+            : Parameters(),
+              AbsoluteDeadline(0),
+              NextRelease(0),
+              RemainingBudget(0),
+              Misses(0),
+              JobComplete(true)
+        {
+        }
+};
+
+#endif /* _DEADLINE_H */
@@ -0,0 +1,32 @@
+#ifndef _HANDLE_H
+#define _HANDLE_H
+
+#include <cstdint>
+
+/// @brief Names a kernel object to the process holding it, see HandleTable. Means nothing to any other process.
+using Handle = uint32_t;
+
+// Never a valid handle.
+#define HANDLE_NONE 0u
+
+/// @brief What a handle lets its process do with the object, as a bit-field.
+enum class HandleRights : uint8_t
+{
+    None = 0x0,
+    /// @brief Block on the object, e.g. SemaphoreWait or RegionQueueReceive.
+    Wait = 0x1,
+    /// @brief Signal or change the object, e.g. SemaphorePost or RegionQueueSend.
+    Signal = 0x2,
+    /// @brief Give the object to another process through DuplicateHandle.
+    Duplicate = 0x4,
+    All = 0x7,
+};
+
+/// @return Whether a set of rights includes all of the wanted ones.
+inline bool
+HasRights(const HandleRights rights, const HandleRights wanted)
+{
+    return (static_cast<uint8_t>(rights) & static_cast<uint8_t>(wanted)) == static_cast<uint8_t>(wanted);
+}
+
+#endif /* _HANDLE_H */
@@ -0,0 +1,101 @@
+#include "handle_table.hpp"
+#include "condition_variable.hpp"
+#include "event_flags.hpp"
+#include "region_queue.hpp"
+#include "semaphore.hpp"
+
+static Handle
+MakeHandle(const uint32_t generation, const uint32_t index)
+{
+    return (generation << HANDLE_INDEX_BITS) | index;
+}
+
+HandleTable::HandleTable()
+    : _entries(),
+      _freeSlots((PROCESS_MAX_HANDLES == 32u) ? 0xffffffffu : ((1u << PROCESS_MAX_HANDLES) - 1u))
+{
+    for (uint32_t i = 0; i < PROCESS_MAX_HANDLES; i++)
+    {
+        // Generations start at 1 so no handle is ever HANDLE_NONE.
+        _entries[i] = Entry{nullptr, 1, KernelObjectType::None, HandleRights::None};
+    }
+}
+
+HandleTable::~HandleTable()
+{
+    for (Entry& entry : _entries)
+    {
+        if (entry.Object != nullptr) Release(*entry.Object, entry.Type);
+    }
+}
+
+void
+HandleTable::Release(KernelObject& object, const KernelObjectType type)
+{
+    if (!object.ReleaseReference()) return;
+
+    // Objects are only ever made by the create requests, with new.
+    switch (type)
+    {
+        case KernelObjectType::Semaphore: delete static_cast<Semaphore*>(&object); break;
+        case KernelObjectType::EventFlags: delete static_cast<EventFlags*>(&object); break;
+        case KernelObjectType::ConditionVariable: delete static_cast<ConditionVariable*>(&object); break;
+        case KernelObjectType::RegionQueue: delete static_cast<RegionQueue*>(&object); break;
+        default: break;
+    }
+}
+
+const HandleTable::Entry*
+HandleTable::FindEntry(const Handle handle) const
+{
+    const uint32_t index = handle & HANDLE_INDEX_MASK;
+    if (index >= PROCESS_MAX_HANDLES) return nullptr;
+    const Entry& entry = _entries[index];
+    if ((entry.Type == KernelObjectType::None) || (entry.Generation != (handle >> HANDLE_INDEX_BITS))) return nullptr;
+    return &entry;
+}
+
+Handle
+HandleTable::Insert(KernelObject* const object, const KernelObjectType type, const HandleRights rights)
+{
+    if (_freeSlots == 0) return HANDLE_NONE;
+
+    // Lowest free slot: RBIT + CLZ.
+    const uint32_t index = static_cast<uint32_t>(__builtin_ctz(_freeSlots));
+    _freeSlots &= ~(1u << index);
+    Entry& entry = _entries[index];
+    entry.Object = object;
+    entry.Type = type;
+    entry.Rights = rights;
+    object->AddReference();
+    return MakeHandle(entry.Generation, index);
+}
+
+KernelResultStatus
+HandleTable::Close(const Handle handle)
+{
+    const Entry* const found = FindEntry(handle);
+    if (found == nullptr) return KernelResultStatus::Error;
+
+    const uint32_t index = handle & HANDLE_INDEX_MASK;
+    Entry& entry = _entries[index];
+    KernelObject* const object = entry.Object;
+    const KernelObjectType type = entry.Type;
+    entry.Object = nullptr;
+    entry.Type = KernelObjectType::None;
+    entry.Rights = HandleRights::None;
+    entry.Generation = (entry.Generation == HANDLE_GENERATION_MAX) ? 1 : static_cast<uint16_t>(entry.Generation + 1);
+    _freeSlots |= 1u << index;
+    // Released once the slot is free, since destroying the object wakes its waiters.
+    Release(*object, type);
+    return KernelResultStatus::Success;
+}
+
+Handle
+HandleTable::Duplicate(const Handle handle, HandleTable& target, const HandleRights rights) const
+{
+    const Entry* const entry = FindEntry(handle);
+    if ((entry == nullptr) || !HasRights(entry->Rights, HandleRights::Duplicate)) return HANDLE_NONE;
+    if (!HasRights(entry->Rights, rights)) return HANDLE_NONE;
+    return target.Insert(entry->Object, entry->Type, rights);
+}
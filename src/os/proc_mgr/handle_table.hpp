@@ -0,0 +1,151 @@
+#ifndef _HANDLE_TABLE_H
+#define _HANDLE_TABLE_H
+
+#include "handle.hpp"
+#include "kernel_object.hpp"
+#include "kernel_result_status.hpp"
+#include <cstdint>
+
+// Handles one process can hold at once.
+#define PROCESS_MAX_HANDLES 16u
+// Low bits of a handle are the slot index, the bits above them the slot's generation.
+#define HANDLE_INDEX_BITS 4u
+#define HANDLE_INDEX_MASK ((1u << HANDLE_INDEX_BITS) - 1u)
+#define HANDLE_GENERATION_MAX 0xffffu
+
+static_assert(PROCESS_MAX_HANDLES <= (HANDLE_INDEX_MASK + 1u), "Slot indices must fit the index bits");
+static_assert(PROCESS_MAX_HANDLES <= 32u, "Free slots are kept in one bitmap word");
+
+class ConditionVariable;
+class EventFlags;
+class RegionQueue;
+class Semaphore;
+
+/// @brief Kinds of kernel object a handle can name. Resolving a handle as the wrong kind finds nothing.
+enum class KernelObjectType : uint8_t
+{
+    /// @brief The slot is free.
+    None,
+    Semaphore,
+    EventFlags,
+    ConditionVariable,
+    RegionQueue,
+    NUM_TYPES,
+};
+
+/// @brief Maps a kernel object class to its KernelObjectType. Only the classes handles can name have one.
+template <class T>
+class KernelObjectTraits;
+
+template <>
+class KernelObjectTraits<Semaphore>
+{
+    public:
+        static constexpr KernelObjectType Type = KernelObjectType::Semaphore;
+};
+
+template <>
+class KernelObjectTraits<EventFlags>
+{
+    public:
+        static constexpr KernelObjectType Type = KernelObjectType::EventFlags;
+};
+
+template <>
+class KernelObjectTraits<ConditionVariable>
+{
+    public:
+        static constexpr KernelObjectType Type = KernelObjectType::ConditionVariable;
+};
+
+template <>
+class KernelObjectTraits<RegionQueue>
+{
+    public:
+        static constexpr KernelObjectType Type = KernelObjectType::RegionQueue;
+};
+
+/* A process's handles to kernel objects. Threads name objects by handle in requests, never by address,
+ * so a thread can only reach the objects the kernel gave its process, with the rights it was given them with.
+ * A handle is a slot index tagged with the slot's generation, which moves on each time the slot is closed,
+ * so a closed handle stops resolving even once its slot is reused, until the generation wraps.
+ * Each handle holds a reference to its object, which is destroyed once the last handle to it is closed.
+ * Only changed with processLock held. Resolving only happens in requests, which that holds off.
+ */
+class HandleTable
+{
+    private:
+        class Entry
+        {
+            public:
+                /// @brief nullptr while the slot is free.
+                KernelObject* Object;
+                uint16_t Generation;
+                KernelObjectType Type;
+                HandleRights Rights;
+        };
+
+        Entry _entries[PROCESS_MAX_HANDLES];
+        /// @brief One bit per slot, set while it is free.
+        uint32_t _freeSlots;
+
+        /// @return The slot a handle names, nullptr if it is stale or was never handed out.
+        const Entry* FindEntry(const Handle handle) const;
+        Handle Insert(KernelObject* const object, const KernelObjectType type, const HandleRights rights);
+        static void Release(KernelObject& object, const KernelObjectType type);
+
+    public:
+        HandleTable();
+        HandleTable(const HandleTable&) = delete;
+        HandleTable(HandleTable&&) = delete;
+        ~HandleTable();
+        HandleTable& operator=(const HandleTable&) = delete;
+        HandleTable& operator=(HandleTable&&) = delete;
+
+        /// @brief Give the process a handle to a kernel object.
+        /// @return The handle, HANDLE_NONE if the table is full.
+        template <class T>
+        Handle Insert(T& object, const HandleRights rights)
+        {
+            return Insert(&object, KernelObjectTraits<T>::Type, rights);
+        }
+
+        /// @brief Find the object a handle names. One bounds check and one slot load, no searching.
+        /// @param wanted Rights the handle must have been given.
+        /// @return The object, nullptr if the handle is stale, names another kind of object or lacks the rights.
+        template <class T>
+        T* Resolve(const Handle handle, const HandleRights wanted) const
+        {
+            const uint32_t index = handle & HANDLE_INDEX_MASK;
+            if (index >= PROCESS_MAX_HANDLES) return nullptr;
+            const Entry& entry = _entries[index];
+            if ((entry.Type != KernelObjectTraits<T>::Type) || (entry.Generation != (handle >> HANDLE_INDEX_BITS))) return nullptr;
+            if (!HasRights(entry.Rights, wanted)) return nullptr;
+            return static_cast<T*>(entry.Object);
+        }
+
+        /// @brief Give up a handle. The object is destroyed if no other handle or reference to it is left.
+        /// @return Error if the handle is stale or was never handed out.
+        KernelResultStatus Close(const Handle handle);
+
+        /// @brief Give another process a handle to the same object.
+        /// @param rights Rights for the new handle. Can only be fewer than the original's, which needs Duplicate.
+        /// @return The new handle in the target's table, HANDLE_NONE if it can't be made.
+        Handle Duplicate(const Handle handle, HandleTable& target, const HandleRights rights) const;
+
+        /// @brief Keep an object alive without a handle to it, e.g. while an async request still has to signal it.
+        template <class T>
+        static void Retain(T& object)
+        {
+            object.AddReference();
+        }
+
+        /// @brief Give up a reference taken with Retain, destroying the object if it was the last.
+        template <class T>
+        static void Release(T& object)
+        {
+            Release(object, KernelObjectTraits<T>::Type);
+        }
+};
+
+#endif /* _HANDLE_TABLE_H */
@@ -0,0 +1,36 @@
+#ifndef _KERNEL_OBJECT_H
+#define _KERNEL_OBJECT_H
+
+#include <cstdint>
+
+/* Base of the kernel objects a handle can name. Counts the handles to the object, plus anything else that keeps
+ * a pointer to it, e.g. an async request that has yet to signal it. The object is destroyed with the last of them,
+ * see HandleTable::Release. Only counted with processLock held.
+ */
+class KernelObject
+{
+    private:
+        uint32_t _references;
+
+    protected:
+        KernelObject()
+            : _references(0)
+        {
+        }
+        ~KernelObject()
+        {
+            // Intentionally do nothing.
+        }
+
+    public:
+        KernelObject(const KernelObject&) = delete;
+        KernelObject(KernelObject&&) = delete;
+        KernelObject& operator=(const KernelObject&) = delete;
+        KernelObject& operator=(KernelObject&&) = delete;
+
+        void AddReference() { _references++; };
+        /// @return Whether that was the last reference, so the object has to be destroyed.
+        bool ReleaseReference() { return --_references == 0; };
+};
+
+#endif /* _KERNEL_OBJECT_H */
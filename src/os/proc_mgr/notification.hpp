@@ -0,0 +1,49 @@
+#ifndef _NOTIFICATION_H
+#define _NOTIFICATION_H
+
+#include <cstdint>
+
+/// @brief How a notification changes the receiving thread's notification value.
+enum class NotifyAction : uint32_t
+{
+    /// @brief OR the bits into the value, e.g. one bit per event an interrupt handler reports.
+    SetBits,
+    /// @brief Add one to the value, so it counts notifications like a semaphore.
+    Increment,
+    /// @brief Replace the value, e.g. with the number of bytes a transfer completed.
+    Overwrite,
+    NUM_ACTIONS,
+};
+
+/// @brief Notification word embedded in every thread. Lets an interrupt handler wake exactly one thread
+///        without a separate synchronisation object.
+class ThreadNotification
+{
+    public:
+        uint32_t Value;
+        /// @brief Bits of the value cleared when the thread takes it.
+        uint32_t ClearOnTake;
+        /// @brief Whether the thread has been notified since it last took the value.
+        bool Pending;
+        /// @brief Whether the thread is blocked waiting to be notified.
+        bool Waiting;
+
+        ThreadNotification()
+            : Value(0),
+              ClearOnTake(0),
+              Pending(false),
+              Waiting(false)
+        {
+        }
+
+        /// @brief Take the value, clearing the given bits of it.
+        uint32_t Take(const uint32_t clearBits)
+        {
+            const uint32_t value = Value;
+            Value &= ~clearBits;
+            Pending = false;
+            return value;
+        }
+};
+
+#endif /* _NOTIFICATION_H */
@@ -1,15 +1,45 @@
 #include "proc_mgr.h"
+#include "kernel_data.hpp"
+#include "kernel_lock.hpp"
+#include "sys_ctl_block.h"
+#include "trace.hpp"
+
+// Fixed-point 1.0 for deadline utilization. Budgets must be below this many ticks so the division doesn't overflow.
+#define DEADLINE_UTILIZATION_MAX (1u << 16)
 
 ProcessManager processManager;
 
+static void
+IdleThreadEntry()
+{
+    while (true)
+    {
+        asm volatile("WFI");
+    }
+}
+
+/// @brief Compares ticks in a way that still works once the tick count wraps.
+static bool
+IsTickReached(const uint32_t now, const uint32_t tick)
+{
+    return static_cast<int32_t>(now - tick) >= 0;
+}
+
 ProcessManager::ProcessManager()
     : _memMgr(nullptr),
       _kernelProcess(), // Don't pass in nullptr - it will try to allocate stack for a thread!
-      _processes(),
-      _readyThreadsRanToCompletion(),
-      _readyThreadsStoppedEarly(),
+      _processTable(),
+      _threadTable(),
+      _readyDeadlineThreads(),
+      _readyPriorityThreads(),
       _blockedThreads(),
-      _runningThreads()
+      _sleepingThreads(),
+      _timedWaitThreads(),
+      _throttledProcesses(),
+      _runningThreads(),
+      _idleThread(),
+      _tickCount(0),
+      _deadlineUtilization(0)
 {
 }
 
@@ -25,16 +55,53 @@ ProcessManager::Initialize(MemoryManager& memMgr, const KernelApi& kernelApi)
     _kernelProcess = Process{0, _memMgr, kernelApi.ApiEntry};
     const auto kernelThread = _kernelProcess.GetMainThread();
     kernelThread->SetThreadMode(true, false);
+    _idleThread = Thread{_kernelProcess, *_memMgr, IdleThreadEntry};
+    // IDs point at where the objects live, so they are handed out once the objects are in place.
+    _kernelProcess._processId = _processTable.Allocate(_kernelProcess);
+    RegisterThread(*kernelThread);
+    RegisterThread(_idleThread);
 }
 
 Process*
 ProcessManager::CreateProcess(const VoidFunction start)
 {
-    auto process = new Process(ROOT_PROCESS_ID, _memMgr, start);
-    _processes.pushBack(process);
+    // Allocating the process and its stack only takes the memory lock, the tables are locked just to add it.
+    auto process = new Process(_kernelProcess.GetId(), _memMgr, start);
+    {
+        KernelLock::Guard guard(processLock);
+        process->_processId = _processTable.Allocate(*process);
+        Thread& mainThread = *process->GetMainThread();
+        // Dead if it couldn't get a stack.
+        if (mainThread._state != ThreadState::Dead) mainThread._threadId = _threadTable.Allocate(mainThread);
+        if ((process->_processId == 0) || (mainThread._threadId == 0))
+        {
+            _processTable.Free(process->_processId);
+            UnregisterThread(mainThread);
+            delete process;
+            return nullptr;
+        }
+    }
+    ReadyThread(*process->GetMainThread(), false);
     return process;
 }
 
+KernelResultStatus
+ProcessManager::RegisterThread(Thread& thread)
+{
+    if (thread._state == ThreadState::Dead) return KernelResultStatus::Error;
+    KernelLock::Guard guard(processLock);
+    thread._threadId = _threadTable.Allocate(thread);
+    return (thread._threadId == 0) ? KernelResultStatus::Error : KernelResultStatus::Success;
+}
+
+void
+ProcessManager::UnregisterThread(Thread& thread)
+{
+    KernelLock::Guard guard(processLock);
+    _threadTable.Free(thread._threadId);
+    thread._threadId = 0;
+}
+
 Thread*
 ProcessManager::CreateThread(Process* parentProcess)
 {
@@ -43,4 +110,547 @@ ProcessManager::CreateThread(Process* parentProcess)
 Thread*
 ProcessManager::ScheduleNextThread(uint32_t core)
 {
+    Thread* const previous = _runningThreads[core];
+    const bool preempted = (previous != nullptr) && (previous->_state == ThreadState::Executing);
+    if (preempted && (previous != &_idleThread))
+    {
+        // Thread was preempted, so it used up its whole time slice.
+        ReadyThread(*previous, false);
+    }
+
+    Thread* next = PopReadyThread();
+    if (next == nullptr) next = &_idleThread;
+
+    if ((previous != nullptr) && (previous != next))
+    {
+        CountSwitch(*previous, preempted);
+    }
+
+    next->_state = ThreadState::Executing;
+    _runningThreads[core] = next;
+    if (core == 0) os::api::kernelData.PublishRunningThread(next->getId());
+    return next;
+}
+
+void
+ProcessManager::CountSwitch(Thread& previous, const bool preempted)
+{
+    ThreadCpuUsage& usage = previous.GetCpuUsage();
+    if (preempted || (previous._state == ThreadState::Throttled) || (previous._state == ThreadState::Depleted))
+    {
+        usage.InvoluntarySwitches++;
+    }
+    else
+    {
+        usage.VoluntarySwitches++;
+    }
+}
+
+void
+ProcessManager::Tick()
+{
+    _tickCount++;
+    os::api::kernelData.PublishTick(_tickCount);
+
+    for (uint32_t core = 0; core < NUM_CPUS; core++)
+    {
+        Thread* const running = _runningThreads[core];
+        if ((running == nullptr) || (running == &_idleThread)) continue;
+        if (running->_schedulingClass == SchedulingClass::Deadline)
+        {
+            ChargeDeadlineTick(*running);
+        }
+        ChargeQuotaTick(*running);
+    }
+
+    // Sleep queue is sorted by wake tick, so only need to look at the front.
+    Thread* sleeper = _sleepingThreads.front();
+    while ((sleeper != nullptr) && IsTickReached(_tickCount, sleeper->_wakeTick))
+    {
+        _sleepingThreads.remove(*sleeper);
+        ReadyThread(*sleeper, true);
+        sleeper = _sleepingThreads.front();
+    }
+
+    // Timed waits are sorted the same way. Their requests already return the timeout result.
+    Thread* waiter = _timedWaitThreads.front();
+    while ((waiter != nullptr) && IsTickReached(_tickCount, waiter->_wakeTick))
+    {
+        WakeThread(*waiter);
+        waiter = _timedWaitThreads.front();
+    }
+
+    // Same for throttled processes, sorted by replenish tick.
+    Process* throttled = _throttledProcesses.front();
+    while ((throttled != nullptr) && IsTickReached(_tickCount, throttled->_cpuQuota.NextReplenish))
+    {
+        CpuQuota& quota = throttled->_cpuQuota;
+        quota.Remaining = quota.Budget;
+        quota.NextReplenish += quota.Period;
+        UnthrottleProcess(*throttled);
+        throttled = _throttledProcesses.front();
+    }
+}
+
+void
+ProcessManager::ReadyThread(Thread& thread, const bool stoppedEarly)
+{
+    KernelLock::Guard guard(schedulerLock);
+    if (thread._parentProcess->_cpuQuota.Throttled)
+    {
+        ThrottleThread(thread);
+        return;
+    }
+
+    if (thread._state != ThreadState::Executing)
+    {
+        TraceRecord(TraceEventType::Wake, thread.getId(), static_cast<uint32_t>(thread._state));
+    }
+    thread._state = ThreadState::Ready;
+    if (thread._schedulingClass == SchedulingClass::Deadline)
+    {
+        if (IsTickReached(_tickCount, thread._deadline.NextRelease))
+        {
+            ReleaseDeadlineJob(thread);
+        }
+        _readyDeadlineThreads.Push(thread);
+    }
+    else
+    {
+        _readyPriorityThreads.Push(thread, stoppedEarly);
+    }
+}
+
+void
+ProcessManager::BlockThread(uint32_t core, const uint32_t timeoutTicks)
+{
+    KernelLock::Guard guard(schedulerLock);
+    Thread* const thread = _runningThreads[core];
+    if ((thread == nullptr) || (thread == &_idleThread)) return;
+
+    thread->_state = ThreadState::Blocked;
+    thread->_waitQueue = &_blockedThreads;
+    _blockedThreads.pushBack(*thread);
+    StartWaitTimeout(*thread, timeoutTicks);
+    TraceRecord(TraceEventType::Block, thread->getId(), static_cast<uint32_t>(ThreadState::Blocked));
+}
+
+void
+ProcessManager::BlockThreadOn(uint32_t core, ThreadQueue& queue, const uint32_t timeoutTicks)
+{
+    KernelLock::Guard guard(schedulerLock);
+    Thread* const thread = _runningThreads[core];
+    if ((thread == nullptr) || (thread == &_idleThread)) return;
+
+    thread->_state = ThreadState::Blocked;
+    thread->_waitQueue = &queue;
+    const uint8_t rank = GetSchedulingRank(*thread);
+    // FIFO among waiters of the same priority.
+    queue.insertSorted(*thread, [rank](const Thread& other)
+                       { return GetSchedulingRank(other) > rank; });
+    StartWaitTimeout(*thread, timeoutTicks);
+    TraceRecord(TraceEventType::Block, thread->getId(), static_cast<uint32_t>(ThreadState::Blocked));
+}
+
+void
+ProcessManager::WakeThread(Thread& thread)
+{
+    KernelLock::Guard guard(schedulerLock);
+    switch (thread._state)
+    {
+    case ThreadState::Blocked: CancelWait(thread); break;
+    case ThreadState::Sleeping: _sleepingThreads.remove(thread); break;
+    default: return;
+    }
+    ReadyThread(thread, true);
+}
+
+void
+ProcessManager::CancelWait(Thread& thread)
+{
+    thread._waitQueue->remove(thread);
+    thread._waitQueue = nullptr;
+    if (thread._timeoutLink.isLinked()) _timedWaitThreads.remove(thread);
+    // Whatever it was waiting for no longer applies.
+    thread._notification.Waiting = false;
+    thread._ipcPhase = IpcPhase::None;
+}
+
+void
+ProcessManager::MoveToBlockedQueue(Thread& thread)
+{
+    KernelLock::Guard guard(schedulerLock);
+    CancelWait(thread);
+    thread._waitQueue = &_blockedThreads;
+    _blockedThreads.pushBack(thread);
+}
+
+void
+ProcessManager::HandOff(uint32_t core, Thread& target, const uint32_t result)
+{
+    KernelLock::Guard guard(schedulerLock);
+    Thread* const previous = _runningThreads[core];
+    const Thread* const nextReady = _readyPriorityThreads.Peek();
+    // Deadline threads go through the ready queue so their jobs are released.
+    const bool runsNext = (target._state == ThreadState::Blocked)
+                          && (target._schedulingClass == SchedulingClass::Priority)
+                          && !target._parentProcess->_cpuQuota.Throttled
+                          && _readyDeadlineThreads.Empty()
+                          && ((nextReady == nullptr) || (target._priority <= nextReady->_priority));
+    if ((previous == nullptr) || (previous->_state == ThreadState::Executing) || !runsNext)
+    {
+        WakeThread(target, result);
+        return;
+    }
+
+    target.GetStackedRegisters()->R0 = result;
+    CancelWait(target);
+    TraceRecord(TraceEventType::Wake, target.getId(), static_cast<uint32_t>(ThreadState::Blocked));
+    CountSwitch(*previous, false);
+    target._state = ThreadState::Executing;
+    _runningThreads[core] = &target;
+    if (core == 0) os::api::kernelData.PublishRunningThread(target.getId());
+}
+
+void
+ProcessManager::StartWaitTimeout(Thread& thread, const uint32_t timeoutTicks)
+{
+    if (timeoutTicks == WAIT_FOREVER) return;
+
+    const uint32_t wakeTick = _tickCount + timeoutTicks;
+    thread._wakeTick = wakeTick;
+    _timedWaitThreads.insertSorted(thread, [wakeTick](const Thread& other)
+                                   { return !IsTickReached(wakeTick, other._wakeTick); });
+}
+
+void
+ProcessManager::WakeThread(Thread& thread, const uint32_t result)
+{
+    KernelLock::Guard guard(schedulerLock);
+    thread.GetStackedRegisters()->R0 = result;
+    WakeThread(thread);
+}
+
+void
+ProcessManager::PreemptIfOutranked(uint32_t core, const Thread& woken, const bool fromInterrupt)
+{
+    KernelLock::Guard guard(schedulerLock);
+    Thread* const running = _runningThreads[core];
+    if ((running == nullptr) || (woken._state != ThreadState::Ready)) return;
+    if ((running != &_idleThread) && (GetSchedulingRank(woken) >= GetSchedulingRank(*running))) return;
+
+    if (fromInterrupt)
+    {
+        request_reschedule();
+    }
+    else
+    {
+        // Called from a request, which switches threads on its way out once the caller isn't executing.
+        YieldThread(core);
+    }
+}
+
+void
+ProcessManager::NotifyThread(uint32_t core, Thread& thread, const NotifyAction action, const uint32_t value, const bool fromInterrupt)
+{
+    KernelLock::Guard guard(schedulerLock);
+    ThreadNotification& notification = thread._notification;
+    switch (action)
+    {
+    case NotifyAction::SetBits: notification.Value |= value; break;
+    case NotifyAction::Increment: notification.Value++; break;
+    case NotifyAction::Overwrite: notification.Value = value; break;
+    default: return;
+    }
+    notification.Pending = true;
+
+    if (!notification.Waiting) return;
+    WakeThread(thread, notification.Take(notification.ClearOnTake));
+    PreemptIfOutranked(core, thread, fromInterrupt);
+}
+
+uint32_t
+ProcessManager::WaitForNotification(uint32_t core, const uint32_t clearBits, const uint32_t timeoutTicks)
+{
+    KernelLock::Guard guard(schedulerLock);
+    Thread* const thread = _runningThreads[core];
+    ThreadNotification& notification = thread->_notification;
+    if (notification.Pending) return notification.Take(clearBits);
+    if (timeoutTicks == 0) return 0;
+
+    notification.Waiting = true;
+    notification.ClearOnTake = clearBits;
+    BlockThread(core, timeoutTicks);
+    // Returned if the wait times out, NotifyThread replaces it.
+    return 0;
+}
+
+void
+ProcessManager::YieldThread(uint32_t core)
+{
+    KernelLock::Guard guard(schedulerLock);
+    Thread* const thread = _runningThreads[core];
+    if ((thread == nullptr) || (thread == &_idleThread)) return;
+
+    ReadyThread(*thread, false);
+}
+
+void
+ProcessManager::SleepThread(uint32_t core, const uint32_t ticks)
+{
+    KernelLock::Guard guard(schedulerLock);
+    Thread* const thread = _runningThreads[core];
+    if ((thread == nullptr) || (thread == &_idleThread)) return;
+
+    InsertSleepingThread(*thread, ThreadState::Sleeping, _tickCount + ticks);
+}
+
+void
+ProcessManager::InsertSleepingThread(Thread& thread, const ThreadState state, const uint32_t wakeTick)
+{
+    thread._state = state;
+    thread._wakeTick = wakeTick;
+    _sleepingThreads.insertSorted(thread, [wakeTick](const Thread& other)
+                                  { return !IsTickReached(wakeTick, other._wakeTick); });
+    TraceRecord(TraceEventType::Block, thread.getId(), static_cast<uint32_t>(state));
+}
+
+void
+ProcessManager::ThrottleThread(Thread& thread)
+{
+    thread._state = ThreadState::Throttled;
+    thread._parentProcess->_throttledThreads.pushBack(thread);
+    TraceRecord(TraceEventType::Block, thread.getId(), static_cast<uint32_t>(ThreadState::Throttled));
+}
+
+Thread*
+ProcessManager::PopReadyThread()
+{
+    // Threads that were already queued when their process got throttled are only moved off the ready queues
+    // once they reach the front. This keeps throttling O(1) no matter how many threads the process has.
+    while (true)
+    {
+        Thread* thread = _readyDeadlineThreads.Pop();
+        if (thread == nullptr) thread = _readyPriorityThreads.Pop();
+        if (thread == nullptr) return nullptr;
+        if (!thread->_parentProcess->_cpuQuota.Throttled) return thread;
+        ThrottleThread(*thread);
+    }
+}
+
+KernelResultStatus
+ProcessManager::SetCpuQuota(Process& process, const uint32_t budgetMs, const uint32_t periodMs)
+{
+    KernelLock::Guard guard(schedulerLock);
+    if (budgetMs > periodMs) return KernelResultStatus::Error;
+
+    CpuQuota& quota = process._cpuQuota;
+    quota.Budget = (budgetMs + SYS_TICK_PERIOD_MS - 1) / SYS_TICK_PERIOD_MS;
+    quota.Period = (periodMs + SYS_TICK_PERIOD_MS - 1) / SYS_TICK_PERIOD_MS;
+    quota.Remaining = quota.Budget;
+    quota.NextReplenish = _tickCount + quota.Period;
+
+    // Starts a fresh period, so a throttled process can run straight away.
+    if (quota.Throttled) UnthrottleProcess(process);
+    return KernelResultStatus::Success;
+}
+
+void
+ProcessManager::UnthrottleProcess(Process& process)
+{
+    _throttledProcesses.remove(process);
+    process._cpuQuota.Throttled = false;
+    while (Thread* const thread = process._throttledThreads.popFront())
+    {
+        ReadyThread(*thread, true);
+    }
+}
+
+void
+ProcessManager::ChargeQuotaTick(Thread& thread)
+{
+    Process& process = *thread._parentProcess;
+    CpuQuota& quota = process._cpuQuota;
+    if (!quota.IsLimited() || quota.Throttled) return;
+
+    // Budget is only refilled here while the process isn't throttled, so catch up on any periods that went by.
+    while (IsTickReached(_tickCount, quota.NextReplenish))
+    {
+        quota.Remaining = quota.Budget;
+        quota.NextReplenish += quota.Period;
+    }
+
+    quota.Remaining--;
+    if (quota.Remaining > 0) return;
+
+    quota.Throttled = true;
+    quota.ThrottleCount++;
+    const uint32_t replenishTick = quota.NextReplenish;
+    _throttledProcesses.insertSorted(process, [replenishTick](const Process& other)
+                                     { return !IsTickReached(replenishTick, other._cpuQuota.NextReplenish); });
+    if (thread._state == ThreadState::Executing)
+    {
+        ThrottleThread(thread);
+    }
+}
+
+void
+ProcessManager::SetThreadPriority(Thread& thread, const uint8_t priority)
+{
+    KernelLock::Guard guard(schedulerLock);
+    if (thread._priority == priority) return;
+
+    // Queues are ordered by priority, so take the thread out before changing it.
+    const bool queuedReady = (thread._state == ThreadState::Ready) && (thread._schedulingClass == SchedulingClass::Priority);
+    ThreadQueue* const waitQueue = (thread._state == ThreadState::Blocked) ? thread._waitQueue : nullptr;
+    if (queuedReady) _readyPriorityThreads.Remove(thread);
+    if (waitQueue != nullptr) waitQueue->remove(thread);
+
+    thread._priority = priority;
+
+    if (queuedReady) _readyPriorityThreads.Push(thread, true);
+    if (waitQueue != nullptr)
+    {
+        const uint8_t rank = GetSchedulingRank(thread);
+        waitQueue->insertSorted(thread, [rank](const Thread& other)
+                                { return GetSchedulingRank(other) > rank; });
+    }
+}
+
+uint8_t
+ProcessManager::GetSchedulingRank(const Thread& thread)
+{
+    if (thread._schedulingClass == SchedulingClass::Deadline) return THREAD_PRIORITY_HIGHEST;
+    return thread._priority;
+}
+
+Thread*
+ProcessManager::FindThread(const uint32_t threadId)
+{
+    KernelLock::Guard guard(processLock);
+    return _threadTable.Find(threadId);
+}
+
+Process*
+ProcessManager::FindProcess(const uint32_t processId)
+{
+    KernelLock::Guard guard(processLock);
+    return _processTable.Find(processId);
+}
+
+KernelResultStatus
+ProcessManager::SetDeadlineParameters(Thread& thread, const DeadlineParameters& parameters)
+{
+    KernelLock::Guard guard(schedulerLock);
+    if ((thread._state != ThreadState::Executing) && (thread._state != ThreadState::Created)) return KernelResultStatus::Error;
+    if ((parameters.Budget == 0) || (parameters.Budget >= DEADLINE_UTILIZATION_MAX)) return KernelResultStatus::Error;
+    if ((parameters.RelativeDeadline < parameters.Budget) || (parameters.Period < parameters.RelativeDeadline)) return KernelResultStatus::Error;
+
+    // Admission control: EDF can meet every deadline as long as the sum of budget / deadline is at most 1.
+    // With deadline == period this is the utilization, otherwise it is a safe over-estimate of it.
+    DeadlineState& deadline = thread._deadline;
+    const uint32_t density = (parameters.Budget * DEADLINE_UTILIZATION_MAX) / parameters.RelativeDeadline;
+    uint32_t utilization = _deadlineUtilization;
+    if (thread._schedulingClass == SchedulingClass::Deadline)
+    {
+        // Replacing the thread's existing parameters.
+        utilization -= (deadline.Parameters.Budget * DEADLINE_UTILIZATION_MAX) / deadline.Parameters.RelativeDeadline;
+    }
+    if (utilization + density > DEADLINE_UTILIZATION_MAX) return KernelResultStatus::Error;
+    _deadlineUtilization = utilization + density;
+
+    thread._schedulingClass = SchedulingClass::Deadline;
+    deadline.Parameters = parameters;
+    deadline.JobComplete = true;
+    deadline.NextRelease = _tickCount;
+    ReleaseDeadlineJob(thread);
+    return KernelResultStatus::Success;
+}
+
+void
+ProcessManager::WaitForNextPeriod(uint32_t core)
+{
+    KernelLock::Guard guard(schedulerLock);
+    Thread* const thread = _runningThreads[core];
+    if ((thread == nullptr) || (thread->_schedulingClass != SchedulingClass::Deadline)) return;
+
+    DeadlineState& deadline = thread->_deadline;
+    if (!IsTickReached(deadline.AbsoluteDeadline, _tickCount))
+    {
+        deadline.Misses++;
+    }
+    deadline.JobComplete = true;
+
+    if (IsTickReached(_tickCount, deadline.NextRelease))
+    {
+        // Already late for the next job, so start it straight away.
+        ReleaseDeadlineJob(*thread);
+        return;
+    }
+    InsertSleepingThread(*thread, ThreadState::Sleeping, deadline.NextRelease);
+}
+
+void
+ProcessManager::ReleaseDeadlineJob(Thread& thread)
+{
+    DeadlineState& deadline = thread._deadline;
+    const DeadlineParameters& parameters = deadline.Parameters;
+    if (!deadline.JobComplete)
+    {
+        deadline.Misses++;
+    }
+
+    // If whole periods went by without the thread running, those jobs were missed too.
+    uint32_t release = deadline.NextRelease;
+    while (IsTickReached(_tickCount, release + parameters.Period))
+    {
+        release += parameters.Period;
+        deadline.Misses++;
+    }
+
+    deadline.AbsoluteDeadline = release + parameters.RelativeDeadline;
+    deadline.NextRelease = release + parameters.Period;
+    deadline.RemainingBudget = parameters.Budget;
+    deadline.JobComplete = false;
+}
+
+void
+ProcessManager::ChargeDeadlineTick(Thread& thread)
+{
+    if (thread._state != ThreadState::Executing) return;
+
+    DeadlineState& deadline = thread._deadline;
+    if (deadline.RemainingBudget > 0)
+    {
+        deadline.RemainingBudget--;
+    }
+
+    if (IsTickReached(_tickCount, deadline.NextRelease))
+    {
+        // Still running when the next job is due.
+        ReleaseDeadlineJob(thread);
+    }
+    else if (deadline.RemainingBudget == 0)
+    {
+        // Out of budget, can't run again until the next job is released.
+        InsertSleepingThread(thread, ThreadState::Depleted, deadline.NextRelease);
+    }
+}
+
+size_t
+ProcessManager::GetCpuUsage(CpuUsageEntry* const entries, const size_t maxEntries)
+{
+    KernelLock::Guard guard(schedulerLock);
+    size_t numEntries = 0;
+    const auto addEntry = [&](Thread& thread)
+    {
+        if (numEntries >= maxEntries) return;
+        CpuUsageEntry& entry = entries[numEntries++];
+        entry.ThreadId = thread.getId();
+        entry.ProcessId = thread.getProcess().GetId();
+        entry.Usage = thread.GetCpuUsage();
+    };
+
+    _threadTable.ForEach(addEntry);
+    return numEntries;
 }
@@ -2,14 +2,23 @@
 #define PROC_MGR_H
 
 #include "cpu.h"
-#include "doubly_linked_list.h"
+#include "cpu_usage.hpp"
+#include "critical_section.h"
+#include "id_table.h"
 #include "kernel_api.hpp"
 #include "mem_mgr.h"
 #include "mpu.h"
 #include "process.h"
+#include "run_queue.hpp"
 #include "thread.h"
 
 using namespace os::api;
+using namespace os::utils::id_table;
+
+// Processes that can exist at once, including the kernel's.
+#define MAX_PROCESSES 16u
+// Threads that can exist at once, including the idle thread and kernel threads.
+#define MAX_THREADS 32u
 
 /* TODO:
  *   - Virtual round robin scheduling:
@@ -30,17 +39,54 @@ using namespace os::api;
  *     - Maybe store some info about capabilities
  *     - Store general state (idle, busy, etc.)
  *     - Could go for performance and have scheduling domains
+ *
+ * Methods that change thread queues take schedulerLock themselves, so requests can be preempted between them.
+ * ScheduleNextThread and Tick are only called by the scheduler, which already holds off everything that uses the kernel.
  */
 class ProcessManager
 {
     private:
         MemoryManager* _memMgr;
         Process _kernelProcess;
-        DoublyLinkedList<Process*> _processes;
-        DoublyLinkedList<Thread*> _readyThreadsRanToCompletion;
-        DoublyLinkedList<Thread*> _readyThreadsStoppedEarly;
-        DoublyLinkedList<Thread*> _blockedThreads;
+        /// @brief Every process, by process ID.
+        IdTable<Process, MAX_PROCESSES> _processTable;
+        /// @brief Every thread that can be looked up, by thread ID.
+        IdTable<Thread, MAX_THREADS> _threadTable;
+        DeadlineRunQueue _readyDeadlineThreads;
+        PriorityRunQueue _readyPriorityThreads;
+        ThreadQueue _blockedThreads;
+        /// @brief Sleeping and throttled deadline threads, sorted by the tick they should be woken at.
+        ThreadQueue _sleepingThreads;
+        /// @brief Blocked threads waiting with a timeout, sorted by the tick the wait times out at.
+        IntrusiveList<Thread, &Thread::_timeoutLink> _timedWaitThreads;
+        /// @brief Processes that used up their CPU quota, sorted by the tick their budget is refilled at.
+        IntrusiveList<Process, &Process::_throttleLink> _throttledProcesses;
         Thread* _runningThreads[NUM_CPUS];
+        /// @brief Runs when no other thread is ready.
+        Thread _idleThread;
+        uint32_t _tickCount;
+        /// @brief Sum of budget / deadline of all deadline threads, as a fraction of DEADLINE_UTILIZATION_MAX.
+        uint32_t _deadlineUtilization;
+
+        void InsertSleepingThread(Thread& thread, const ThreadState state, const uint32_t wakeTick);
+        /// @brief Wakes a blocked thread after a number of ticks, unless something else wakes it first.
+        void StartWaitTimeout(Thread& thread, const uint32_t timeoutTicks);
+        /// @brief Takes a blocked thread out of the queue it waits in and cancels its timeout, leaving it blocked.
+        void CancelWait(Thread& thread);
+        /// @brief Counts a switch away from a thread in its CPU usage.
+        void CountSwitch(Thread& previous, const bool preempted);
+        /// @brief Starts the next job of a deadline thread, counting a miss if the current one is unfinished.
+        void ReleaseDeadlineJob(Thread& thread);
+        /// @brief Charges a tick to a running deadline thread, throttling it when it runs out of budget.
+        void ChargeDeadlineTick(Thread& thread);
+        /// @brief Charges a tick to the process of a running thread, throttling the process when it runs out of quota.
+        void ChargeQuotaTick(Thread& thread);
+        /// @brief Moves a ready thread of a throttled process to the process's throttled queue.
+        void ThrottleThread(Thread& thread);
+        /// @brief Lets the threads of a throttled process run again.
+        void UnthrottleProcess(Process& process);
+        /// @brief Pops the next thread to run from the ready queues, skipping threads of throttled processes.
+        Thread* PopReadyThread();
 
     public:
         ProcessManager();
@@ -55,9 +101,113 @@ class ProcessManager
         /// @param memMgr The memory manager to use for allocating memory to processes.
         void Initialize(MemoryManager& memMgr, const KernelApi& kernelApi);
         Process* GetKernelProcess() { return &_kernelProcess; };
+        /// @return The new process, nullptr if there is no ID left for it or its main thread.
         Process* CreateProcess(const VoidFunction start);
         Thread* CreateThread(Process* parentProcess);
+        /// @brief Give a thread created outside the process manager, e.g. a kernel thread, its ID. Constant time.
+        /// The thread must not move afterwards.
+        /// @return Error if every thread ID is in use, or the thread has no stack.
+        KernelResultStatus RegisterThread(Thread& thread);
+        /// @brief Give up a thread's ID, so it can be reused. Lookups of the old ID fail from then on.
+        void UnregisterThread(Thread& thread);
+
+        /// @brief Picks the thread to run next on a core. A still-executing thread is put back on the ready queue.
+        /// @param core The core that is switching threads.
+        /// @return The thread to switch to, the idle thread if nothing else is ready.
         Thread* ScheduleNextThread(uint32_t core);
+        Thread* GetRunningThread(uint32_t core) const { return _runningThreads[core]; };
+        /// @return The thread with the given ID, or nullptr if there is none. Constant time.
+        Thread* FindThread(const uint32_t threadId);
+        /// @return The process with the given ID, or nullptr if there is none. Constant time.
+        Process* FindProcess(const uint32_t processId);
+
+        /// @brief Advances the tick count, enforces deadline budgets and process quotas,
+        ///        and wakes any sleeping or throttled threads that are due.
+        void Tick();
+        uint32_t GetTickCount() const { return _tickCount; };
+
+        /// @brief Makes a newly created or woken thread eligible to run.
+        /// @param thread The thread to make ready. It must not be in any queue.
+        /// @param stoppedEarly Whether the thread gave up the CPU before its time slice ended.
+        ///                     These threads are scheduled ahead of the ones that used their whole slice.
+        void ReadyThread(Thread& thread, const bool stoppedEarly);
+        /// @brief Moves the running thread on a core to the blocked queue. A new thread must then be scheduled.
+        /// @param timeoutTicks Ticks after which the thread is woken anyway, or WAIT_FOREVER.
+        void BlockThread(uint32_t core, const uint32_t timeoutTicks = WAIT_FOREVER);
+        /// @brief Moves the running thread on a core to a wait queue, ordered by priority. A new thread must then be scheduled.
+        /// @param queue The queue to wait in, e.g. of a mutex. Highest priority waiters are at the front.
+        /// @param timeoutTicks Ticks after which the thread is woken anyway, or WAIT_FOREVER.
+        ///                     The thread's request returns whatever it was going to return when it blocked.
+        void BlockThreadOn(uint32_t core, ThreadQueue& queue, const uint32_t timeoutTicks = WAIT_FOREVER);
+        /// @brief Moves a blocked or sleeping thread back to the ready queue, removing it from whichever queue it waits in.
+        void WakeThread(Thread& thread);
+        /// @brief Wakes a thread blocked in a request, changing what the request returns.
+        /// @param result Value returned to the thread from its request.
+        void WakeThread(Thread& thread, const uint32_t result);
+        /// @brief Moves a blocked thread out of the queue it waits in to the blocked queue, cancelling any timeout.
+        /// The thread stays blocked until woken, e.g. a caller that has sent its message and now waits for the reply.
+        void MoveToBlockedQueue(Thread& thread);
+        /// @brief Wakes a blocked thread and switches the core straight to it, without going through the ready queues.
+        /// The running thread must have just stopped executing. Falls back to WakeThread if the target
+        /// shouldn't run next, e.g. a higher priority thread is ready or its process is throttled.
+        /// @param target The thread to run.
+        /// @param result Value returned to the target from its request.
+        void HandOff(uint32_t core, Thread& target, const uint32_t result);
+        /// @brief Switches away from the running thread on a core if a woken thread should run instead.
+        /// @param woken The thread that was just woken.
+        /// @param fromInterrupt Whether called from an interrupt handler rather than a request from the running thread.
+        void PreemptIfOutranked(uint32_t core, const Thread& woken, const bool fromInterrupt);
+        /// @brief Puts the running thread on a core at the back of its ready queue, so another thread can run.
+        void YieldThread(uint32_t core);
+        /// @brief Moves the running thread on a core to the sleep queue. A new thread must then be scheduled.
+        /// @param ticks Number of ticks to sleep for.
+        void SleepThread(uint32_t core, const uint32_t ticks);
+
+        /// @brief Updates a thread's notification value, waking the thread if it is waiting for it.
+        /// Constant time. The caller yields, or PendSV is pended from an interrupt, if the thread has a higher priority.
+        /// @param core The core the caller is running on.
+        /// @param thread The thread to notify.
+        /// @param action How to change the notification value.
+        /// @param value Operand of the action, unused for Increment.
+        /// @param fromInterrupt Whether called from an interrupt handler rather than a request from the running thread.
+        void NotifyThread(uint32_t core, Thread& thread, const NotifyAction action, const uint32_t value, const bool fromInterrupt);
+        void NotifyThreadFromIsr(Thread& thread, const NotifyAction action, const uint32_t value)
+        {
+            CriticalSection critical;
+            NotifyThread(0, thread, action, value, true);
+        };
+        /// @brief Takes the notification value of the running thread on a core, blocking it until it is notified.
+        /// @param clearBits Bits of the value to clear once taken, all of them to count or consume notifications.
+        /// @param timeoutTicks How long to block for. 0 doesn't block, WAIT_FOREVER never times out.
+        /// @return The notification value, 0 if the wait timed out.
+        uint32_t WaitForNotification(uint32_t core, const uint32_t clearBits, const uint32_t timeoutTicks);
+        /// @brief Changes the priority a thread is scheduled at, moving it within its ready or wait queue.
+        void SetThreadPriority(Thread& thread, const uint8_t priority);
+        /// @brief Orders threads across scheduling classes, for queues that mix them.
+        /// @return The thread's priority, or the highest priority for deadline threads.
+        static uint8_t GetSchedulingRank(const Thread& thread);
+        /// @brief Moves a thread into the deadline scheduling class, if there is enough CPU capacity left for it.
+        /// Its first job is released immediately.
+        /// @param thread The thread to schedule by deadline.
+        /// @param parameters Period, budget and deadline of the thread's jobs.
+        /// @return Error if the parameters are invalid or the total utilization would go above 1.
+        KernelResultStatus SetDeadlineParameters(Thread& thread, const DeadlineParameters& parameters);
+        /// @brief Limits the CPU time all threads of a process can use. Once used up, its threads
+        ///        are held off the ready queues until the budget is refilled at the start of the next period.
+        /// @param process The process to limit.
+        /// @param budgetMs CPU time the process may use per period, rounded up to whole ticks. 0 removes the limit.
+        /// @param periodMs Length of the period, rounded up to whole ticks.
+        /// @return Error if the budget is longer than the period.
+        KernelResultStatus SetCpuQuota(Process& process, const uint32_t budgetMs, const uint32_t periodMs);
+        /// @brief Marks the current job of the running deadline thread on a core complete,
+        ///        and puts it to sleep until its next job is released.
+        void WaitForNextPeriod(uint32_t core);
+
+        /// @brief Collects the CPU usage of every thread.
+        /// @param entries Where to write the usage of each thread.
+        /// @param maxEntries Size of the entries array.
+        /// @return The number of entries written.
+        size_t GetCpuUsage(CpuUsageEntry* const entries, const size_t maxEntries);
 };
 
 extern ProcessManager processManager;
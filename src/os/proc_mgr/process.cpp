@@ -1,12 +1,5 @@
 #include "process.h"
-
-static uint32_t processCounter = ROOT_PROCESS_ID;
-static uint32_t
-getNextProcessId()
-{
-    processCounter++;
-    return processCounter;
-}
+#include "shared_memory.hpp"
 
 Process::Process()
     : _parentProcessId(0),
@@ -15,22 +8,36 @@ Process::Process()
       _state(ProcessState::Dead),
       _swapped(false),
       _returnCode(0),
+      _memRegions(),
+      _stackRegions(),
+      _sharedRegions(),
       _mainThread(),
-      _memRegionList(),
-      _threadList()
+      _threadList(),
+      _cpuQuota(),
+      _throttledThreads(),
+      _throttleLink(*this),
+      _syscallRing(nullptr),
+      _handles()
 {
 }
 
 Process::Process(const uint32_t parentProcessId, MemoryManager* const memMgr, const VoidFunction startAddress)
     : _parentProcessId(parentProcessId),
-      _processId(getNextProcessId()),
+      _processId(0), // Given by the process manager once the process is in place.
       _memMgr(memMgr),
       _state(ProcessState::Created),
       _swapped(false),
       _returnCode(0),
+      _memRegions(),
+      _stackRegions(),
+      _sharedRegions(),
       _mainThread(*this, *memMgr, startAddress),
-      _memRegionList(),
-      _threadList()
+      _threadList(),
+      _cpuQuota(),
+      _throttledThreads(),
+      _throttleLink(*this),
+      _syscallRing(nullptr),
+      _handles()
 {
 }
 
@@ -41,9 +48,16 @@ Process::Process(const Process& other)
       _state(other._state),
       _swapped(other._swapped),
       _returnCode(other._returnCode),
+      _memRegions(other._memRegions),
+      _stackRegions(other._stackRegions),
+      _sharedRegions(), // Attachments are counted per process, the copy starts with none.
       _mainThread(other._mainThread),
-      _memRegionList(other._memRegionList),
-      _threadList(other._threadList)
+      _threadList(other._threadList),
+      _cpuQuota(other._cpuQuota),
+      _throttledThreads(), // Threads can only be queued in one place, so the copy starts with none throttled.
+      _throttleLink(*this),
+      _syscallRing(other._syscallRing),
+      _handles() // Handles stay with the process they were given to, the copy starts with none.
 {
 }
 
@@ -62,10 +76,12 @@ Process::~Process()
         Thread thread = _threadList.popFront();
         thread.~Thread();
     }
-    while (!_memRegionList.empty())
+    MemoryManager* const memMgr = _memMgr;
+    _memRegions.ForEach([memMgr](const MemRegion& memRegion) { memMgr->Free(memRegion); });
+    _stackRegions.ForEach([memMgr](const MemRegion& memRegion) { memMgr->Free(memRegion); });
+    while (!_sharedRegions.IsEmpty())
     {
-        const MemRegion memRegion = _memRegionList.popFront();
-        _memMgr->Free(memRegion);
+        sharedMemoryManager.Detach(*this, _sharedRegions.First().start());
     }
 }
 
@@ -80,8 +96,14 @@ Process::operator=(const Process& other)
     _state = other._state;
     _swapped = other._swapped;
     _returnCode = other._returnCode;
-    _memRegionList = other._memRegionList;
+    _memRegions = other._memRegions;
+    _stackRegions = other._stackRegions;
+    // Attachments stay with the process that made them.
     _threadList = other._threadList;
+    _cpuQuota = other._cpuQuota;
+    // Throttled threads stay where they are queued.
+    _syscallRing = other._syscallRing;
+    // Handles stay with the process they were given to.
 
     return *this;
 }
@@ -109,12 +131,30 @@ Process::operator=(Process&& other)
     _returnCode = other._returnCode;
     other._returnCode = 0;
 
-    _memRegionList = other._memRegionList;
-    other._memRegionList.clear();
+    // The main thread moves with the process, and belongs to it where it now lives.
+    _mainThread = static_cast<Thread&&>(other._mainThread);
+    _mainThread._parentProcess = this;
+
+    _memRegions = other._memRegions;
+    other._memRegions = RegionMap<PROCESS_MAX_MEM_REGIONS>();
+
+    _stackRegions = other._stackRegions;
+    other._stackRegions = RegionMap<PROCESS_MAX_STACKS>();
+
+    _sharedRegions = other._sharedRegions;
+    other._sharedRegions = RegionMap<MAX_SHARED_MEMORY_OBJECTS>();
 
     _threadList = other._threadList;
     other._threadList.clear();
 
+    _cpuQuota = other._cpuQuota;
+    other._cpuQuota = CpuQuota{};
+    // Throttled threads stay where they are queued.
+
+    _syscallRing = other._syscallRing;
+    other._syscallRing = nullptr;
+    // Handles stay with the process they were given to.
+
     return *this;
 }
 
@@ -123,12 +163,68 @@ Process::AllocateMemory(const size_t numBytes)
 {
     const MemRegion memRegion = _memMgr->Allocate(numBytes);
     if (memRegion.start() == 0) return nullptr;
-    AddMemRegion(memRegion);
+    if (!AddMemRegion(memRegion))
+    {
+        _memMgr->Free(memRegion);
+        return nullptr;
+    }
     return reinterpret_cast<void*>(memRegion.start());
 }
 
-void
+bool
 Process::AddMemRegion(const MemRegion& memRegion)
 {
-    _memRegionList.pushBack(memRegion);
+    // Whatever the region was allocated with, the process that owns it can use it.
+    const MemPermisions perms = memRegion.perms() | MemPermisions::Read | MemPermisions::Write;
+    return _memRegions.Add(MemRegion{memRegion.start(), memRegion.size(), perms});
+}
+
+bool
+Process::CanAddMemRegion() const
+{
+    return !_memRegions.IsFull();
+}
+
+bool
+Process::TakeMemRegion(const uintptr_t start, MemRegion& region)
+{
+    return _memRegions.Take(start, region);
+}
+
+size_t
+Process::GetMemRegionSize(const uintptr_t start) const
+{
+    const MemRegion* const region = _memRegions.Find(start);
+    return region == nullptr ? 0 : region->size();
+}
+
+bool
+Process::AddStackRegion(const MemRegion& memRegion)
+{
+    return _stackRegions.Add(MemRegion{memRegion.start(), memRegion.size(), MemPermisions::Read | MemPermisions::Write});
+}
+
+bool
+Process::AddSharedRegion(const MemRegion& memRegion)
+{
+    return _sharedRegions.Add(memRegion);
+}
+
+bool
+Process::TakeSharedRegion(const uintptr_t start, MemRegion& region)
+{
+    return _sharedRegions.Take(start, region);
+}
+
+bool
+Process::HasSharedRegion(const uintptr_t start) const
+{
+    return _sharedRegions.Find(start) != nullptr;
+}
+
+bool
+Process::ValidateUserRange(const uintptr_t start, const size_t length, const MemPermisions wanted) const
+{
+    return _memRegions.Covers(start, length, wanted) || _stackRegions.Covers(start, length, wanted) ||
+           _sharedRegions.Covers(start, length, wanted);
 }
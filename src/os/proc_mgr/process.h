@@ -1,19 +1,32 @@
 #ifndef _PROCESS_H
 #define _PROCESS_H
 
+#include "cpu_quota.hpp"
 #include "doubly_linked_list.h"
+#include "handle_table.hpp"
+#include "intrusive_list.h"
 #include "mem_mgr.h"
 #include "mem_region.hpp"
 #include "misc.hpp"
+#include "region_map.hpp"
+#include "shared_memory.hpp"
 #include "thread.h"
 #include <cstddef>
 #include <cstdint>
 
 #define MAX_MPU_REGIONS 8
-#define ROOT_PROCESS_ID 1
+// Memory regions one process can own at once, e.g. its allocations and regions received through a RegionQueue.
+#define PROCESS_MAX_MEM_REGIONS 32u
+// Threads one process can have stacks for at once.
+#define PROCESS_MAX_STACKS 8u
 
 using namespace os::utils::linked_list;
 
+namespace os::api
+{
+    class SyscallRing;
+}
+
 enum class ProcessState : uint8_t
 {
     Created,
@@ -28,6 +41,8 @@ enum class ProcessState : uint8_t
 /// @brief Represents a Process on the system.
 class Process
 {
+        friend class ProcessManager;
+
     private:
         uint32_t _parentProcessId;
         uint32_t _processId;
@@ -37,10 +52,26 @@ class Process
         bool _swapped;
         uint32_t _returnCode;
 
+        /// @brief Memory the process owns, which it can read and write.
+        RegionMap<PROCESS_MAX_MEM_REGIONS> _memRegions;
+        /// @brief Its threads' stacks. Usable like owned memory, but never handed over to another process.
+        RegionMap<PROCESS_MAX_STACKS> _stackRegions;
+        /// @brief Shared memory the process is attached to, with the permissions it was attached with.
+        RegionMap<MAX_SHARED_MEMORY_OBJECTS> _sharedRegions;
+        /// @brief Declared after the regions, since constructing it adds its stack to them.
         Thread _mainThread;
-        DoublyLinkedList<MemRegion> _memRegionList;
         DoublyLinkedList<Thread> _threadList;
 
+        CpuQuota _cpuQuota;
+        /// @brief Threads that were ready to run when the process ran out of budget.
+        ThreadQueue _throttledThreads;
+        /// @brief Links the process into the list of throttled processes.
+        IntrusiveListNode<Process> _throttleLink;
+        /// @brief Requests queued by the process's threads, nullptr until one is registered.
+        os::api::SyscallRing* _syscallRing;
+        /// @brief Kernel objects the process's threads can name in requests.
+        HandleTable _handles;
+
     public:
         /// @brief Included for flexibility, not intended for actually creating processes.
         /// Use Process::Process(const uint32_t, MemoryManager* const) instead.
@@ -77,12 +108,46 @@ class Process
         void Sleep();
         void Wake();
 
+        uint32_t GetId() const { return _processId; };
+        uint32_t GetParentId() const { return _parentProcessId; };
+        const CpuQuota& GetCpuQuota() const { return _cpuQuota; };
+        os::api::SyscallRing* GetSyscallRing() const { return _syscallRing; };
+        void SetSyscallRing(os::api::SyscallRing* const ring) { _syscallRing = ring; };
+        HandleTable& GetHandles() { return _handles; };
         Thread* GetMainThread() { return &_mainThread; };
         Thread* CreateThread();
         void DestroyThread(Thread* thread);
 
         void* AllocateMemory(const size_t numBytes);
-        void AddMemRegion(const MemRegion&);
+        /// @brief Give the process a region, e.g. one handed over from another process.
+        /// @return Whether it was added, false if the process already owns as many regions as it can.
+        bool AddMemRegion(const MemRegion&);
+        /// @return Whether the process can be given another region.
+        bool CanAddMemRegion() const;
+        /// @brief Remove a region from the process, e.g. to hand it over to another one.
+        /// @param start Start address of the region.
+        /// @param region Set to the region removed.
+        /// @return Whether the process owned a region starting at that address.
+        bool TakeMemRegion(const uintptr_t start, MemRegion& region);
+        /// @return The size of the process's region starting at an address, 0 if it has none there.
+        size_t GetMemRegionSize(const uintptr_t start) const;
+
+        /// @brief Record a thread's stack, so the thread can pass pointers to its stack variables in requests.
+        /// @return Whether it was added, false if the process has as many stacks as it can.
+        bool AddStackRegion(const MemRegion&);
+
+        /// @return Whether it was added, false if the process is attached to as much shared memory as it can be.
+        bool AddSharedRegion(const MemRegion&);
+        /// @brief Remove a shared region from the process, as TakeMemRegion.
+        bool TakeSharedRegion(const uintptr_t start, MemRegion& region);
+        /// @return Whether the process is attached to shared memory starting at an address.
+        bool HasSharedRegion(const uintptr_t start) const;
+
+        /// @brief Check a range a thread of the process passed to the kernel, e.g. a request's buffer.
+        /// A binary search of the process's regions, so cheap enough for every request that takes one.
+        /// @return Whether the whole range is in memory the process owns or is attached to, with the wanted permissions.
+        ///         A range must lie in owned memory, one stack or shared memory, not partly in several.
+        bool ValidateUserRange(const uintptr_t start, const size_t length, const MemPermisions wanted) const;
 };
 
 #endif
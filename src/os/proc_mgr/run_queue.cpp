@@ -0,0 +1,80 @@
+#include "run_queue.hpp"
+
+PriorityRunQueue::PriorityRunQueue()
+    : _threads(),
+      _readyPriorities(0)
+{
+}
+
+PriorityRunQueue::~PriorityRunQueue()
+{
+    // Intentionally do nothing.
+}
+
+void
+PriorityRunQueue::Push(Thread& thread, const bool stoppedEarly)
+{
+    const uint8_t priority = thread.GetPriority();
+    if (stoppedEarly)
+    {
+        _threads[priority].pushFront(thread);
+    }
+    else
+    {
+        _threads[priority].pushBack(thread);
+    }
+    _readyPriorities |= (1u << priority);
+}
+
+void
+PriorityRunQueue::Remove(Thread& thread)
+{
+    const uint8_t priority = thread.GetPriority();
+    _threads[priority].remove(thread);
+    if (_threads[priority].empty())
+    {
+        _readyPriorities &= ~(1u << priority);
+    }
+}
+
+Thread*
+PriorityRunQueue::Peek() const
+{
+    if (Empty()) return nullptr;
+    // Lower number is higher priority. Compiles to RBIT + CLZ.
+    const unsigned highestPriority = __builtin_ctz(_readyPriorities);
+    return _threads[highestPriority].front();
+}
+
+Thread*
+PriorityRunQueue::Pop()
+{
+    Thread* const thread = Peek();
+    if (thread != nullptr) Remove(*thread);
+    return thread;
+}
+
+DeadlineRunQueue::DeadlineRunQueue()
+    : _threads()
+{
+}
+
+DeadlineRunQueue::~DeadlineRunQueue()
+{
+    // Intentionally do nothing.
+}
+
+void
+DeadlineRunQueue::Push(Thread& thread)
+{
+    const uint32_t deadline = thread.GetDeadlineState().AbsoluteDeadline;
+    // Ties go to the thread that was queued first. Compare by difference so this works once ticks wrap.
+    _threads.insertSorted(thread, [deadline](const Thread& other)
+                          { return static_cast<int32_t>(deadline - other.GetDeadlineState().AbsoluteDeadline) < 0; });
+}
+
+void
+DeadlineRunQueue::Remove(Thread& thread)
+{
+    _threads.remove(thread);
+}
@@ -0,0 +1,56 @@
+#ifndef _RUN_QUEUE_H
+#define _RUN_QUEUE_H
+
+#include "thread.h"
+#include <cstdint>
+
+/// @brief Ready threads of the priority scheduling class, with a queue per priority.
+/// Threads that stopped early (blocked or slept) are queued ahead of threads that used their whole time slice.
+class PriorityRunQueue
+{
+    private:
+        ThreadQueue _threads[NUM_THREAD_PRIORITIES];
+        /// @brief Bit N is set when priority N has ready threads. Finds the highest priority in a couple of instructions.
+        uint32_t _readyPriorities;
+
+    public:
+        PriorityRunQueue();
+        PriorityRunQueue(const PriorityRunQueue&) = delete;
+        PriorityRunQueue(PriorityRunQueue&&) = delete;
+        ~PriorityRunQueue();
+        PriorityRunQueue& operator=(const PriorityRunQueue&) = delete;
+        PriorityRunQueue& operator=(PriorityRunQueue&&) = delete;
+
+        void Push(Thread& thread, const bool stoppedEarly);
+        /// @brief Remove a thread from its queue. The thread must be in this run queue.
+        void Remove(Thread& thread);
+        /// @return The first thread of the highest ready priority, or nullptr if no threads are ready.
+        Thread* Peek() const;
+        Thread* Pop();
+        bool Empty() const { return _readyPriorities == 0; };
+};
+
+/// @brief Ready threads of the deadline scheduling class, ordered by absolute deadline.
+class DeadlineRunQueue
+{
+    private:
+        ThreadQueue _threads;
+
+    public:
+        DeadlineRunQueue();
+        DeadlineRunQueue(const DeadlineRunQueue&) = delete;
+        DeadlineRunQueue(DeadlineRunQueue&&) = delete;
+        ~DeadlineRunQueue();
+        DeadlineRunQueue& operator=(const DeadlineRunQueue&) = delete;
+        DeadlineRunQueue& operator=(DeadlineRunQueue&&) = delete;
+
+        void Push(Thread& thread);
+        /// @brief Remove a thread from the queue. The thread must be in this run queue.
+        void Remove(Thread& thread);
+        /// @return The thread with the earliest deadline, or nullptr if no threads are ready.
+        Thread* Peek() const { return _threads.front(); };
+        Thread* Pop() { return _threads.popFront(); };
+        bool Empty() const { return _threads.empty(); };
+};
+
+#endif /* _RUN_QUEUE_H */
@@ -1,36 +1,73 @@
 #include "thread.h"
 #include "alloc.h"
+#include "process.h"
 
 #define STACK_SIZE (2 * 1024)
 
-static uint32_t threadCounter = 0;
-static uint32_t
-getNextThreadId()
-{
-    threadCounter++;
-    return threadCounter;
-}
-
 Thread::Thread()
     : _threadId(0),
       _parentProcess(nullptr),
       _state(ThreadState::Dead),
+      _queueLink(*this),
+      _waitQueue(nullptr),
+      _timeoutLink(*this),
+      _wakeTick(0),
+      _waitMask(0),
+      _waitOptions(0),
+      _waitRegion(0),
+      _notification(),
+      _ipcPhase(IpcPhase::None),
+      _ipcPartner(0),
+      _ipcSenders(),
+      _schedulingClass(SchedulingClass::Priority),
+      _priority(THREAD_PRIORITY_DEFAULT),
+      _basePriority(THREAD_PRIORITY_DEFAULT),
+      _waitingMutex(nullptr),
+      _heldMutexes(nullptr),
+      _deadline(),
       _privileged(false),
       _savedRegs(),
-      _stack()
+      _stack(),
+      _cpuUsage()
 {
 }
 
 Thread::Thread(Process& parentProcess, MemoryManager& memMgr, const VoidFunction startAddress)
-    : _threadId(getNextThreadId()),
+    : _threadId(0), // Given by the process manager once the thread is in place.
       _parentProcess(&parentProcess),
       _state(ThreadState::Created),
+      _queueLink(*this),
+      _waitQueue(nullptr),
+      _timeoutLink(*this),
+      _wakeTick(0),
+      _waitMask(0),
+      _waitOptions(0),
+      _waitRegion(0),
+      _notification(),
+      _ipcPhase(IpcPhase::None),
+      _ipcPartner(0),
+      _ipcSenders(),
+      _schedulingClass(SchedulingClass::Priority),
+      _priority(THREAD_PRIORITY_DEFAULT),
+      _basePriority(THREAD_PRIORITY_DEFAULT),
+      _waitingMutex(nullptr),
+      _heldMutexes(nullptr),
+      _deadline(),
       _privileged(false),
       _savedRegs(),
-      _stack(memMgr.Allocate(PAGE_SIZE))
+      _stack(memMgr.Allocate(PAGE_SIZE)),
+      _cpuUsage()
 {
-    // Initialize stack so we can access the stacked registers.
-    _savedRegs.SetStackPointer(_stack.start());
+    // A thread without a recorded stack stays dead, the process manager won't give it an ID.
+    if ((_stack.start() == 0) || !parentProcess.AddStackRegion(_stack))
+    {
+        if (_stack.start() != 0) memMgr.Free(_stack);
+        _stack = MemRegion();
+        _state = ThreadState::Dead;
+        return;
+    }
+    // Initialize stack so we can access the stacked registers. It is full-descending, so starts at the top.
+    _savedRegs.SetStackPointer(_stack.start() + _stack.size());
     _savedRegs.SetExceptionLR(true, true);
     // Then, setup the stacked registers.
     auto stackedRegs = GetStackedRegisters();
@@ -42,9 +79,27 @@ Thread::Thread(const Thread& source)
     : _threadId(source._threadId),
       _parentProcess(source._parentProcess),
       _state(source._state),
+      _queueLink(*this), // A copy is not part of the source's queue.
+      _waitQueue(nullptr),
+      _timeoutLink(*this),
+      _wakeTick(source._wakeTick),
+      _waitMask(source._waitMask),
+      _waitOptions(source._waitOptions),
+      _waitRegion(source._waitRegion),
+      _notification(source._notification),
+      _ipcPhase(IpcPhase::None), // Blocked senders stay with the source.
+      _ipcPartner(0),
+      _ipcSenders(),
+      _schedulingClass(source._schedulingClass),
+      _priority(source._priority),
+      _basePriority(source._basePriority),
+      _waitingMutex(nullptr), // Nor does it wait on or hold the source's mutexes.
+      _heldMutexes(nullptr),
+      _deadline(source._deadline),
       _privileged(source._privileged),
       _savedRegs(source._savedRegs),
-      _stack(source._stack)
+      _stack(source._stack),
+      _cpuUsage(source._cpuUsage)
 {
 }
 
@@ -66,9 +121,21 @@ Thread::operator=(const Thread& source)
     _threadId = source._threadId;
     _parentProcess = source._parentProcess;
     _state = source._state;
+    // Queue membership is not copied, this thread stays in whichever queue it was already in.
+    _wakeTick = source._wakeTick;
+    _waitMask = source._waitMask;
+    _waitOptions = source._waitOptions;
+    _waitRegion = source._waitRegion;
+    _notification = source._notification;
+    _schedulingClass = source._schedulingClass;
+    _priority = source._priority;
+    _basePriority = source._basePriority;
+    // Mutexes are waited on and held by the thread that locked them, they are not copied.
+    _deadline = source._deadline;
     _privileged = source._privileged;
     _savedRegs = source._savedRegs;
     _stack = source._stack;
+    _cpuUsage = source._cpuUsage;
 
     return *this;
 }
@@ -87,6 +154,35 @@ Thread::operator=(Thread&& source)
     _state = source._state;
     source._state = ThreadState::Dead;
 
+    // Queue membership is not moved, this thread stays in whichever queue it was already in.
+    _wakeTick = source._wakeTick;
+    source._wakeTick = 0;
+
+    _waitMask = source._waitMask;
+    source._waitMask = 0;
+
+    _waitOptions = source._waitOptions;
+    source._waitOptions = 0;
+    _waitRegion = source._waitRegion;
+    source._waitRegion = 0;
+
+    _notification = source._notification;
+    source._notification = ThreadNotification{};
+
+    _schedulingClass = source._schedulingClass;
+    source._schedulingClass = SchedulingClass::Priority;
+
+    _priority = source._priority;
+    source._priority = THREAD_PRIORITY_DEFAULT;
+
+    _basePriority = source._basePriority;
+    source._basePriority = THREAD_PRIORITY_DEFAULT;
+
+    // Mutexes are waited on and held by the thread that locked them, they are not moved.
+
+    _deadline = source._deadline;
+    source._deadline = DeadlineState{};
+
     _privileged = source._privileged;
     source._privileged = false;
 
@@ -95,6 +191,9 @@ Thread::operator=(Thread&& source)
 
     _stack = source._stack;
 
+    _cpuUsage = source._cpuUsage;
+    source._cpuUsage = ThreadCpuUsage{};
+
     return *this;
 }
 
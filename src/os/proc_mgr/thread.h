@@ -2,40 +2,122 @@
 #define _THREAD_H
 
 #include "cpu.h"
+#include "cpu_usage.hpp"
+#include "deadline.hpp"
+#include "intrusive_list.h"
+#include "notification.hpp"
 #include "kernel_result_status.hpp"
 #include "mem_mgr.h"
 #include "mem_region.hpp"
 #include "misc.hpp"
 #include <cstdint>
 
+// Lower number is higher priority, like the NVIC.
+#define NUM_THREAD_PRIORITIES 8u
+#define THREAD_PRIORITY_HIGHEST 0u
+#define THREAD_PRIORITY_DEFAULT 4u
+#define THREAD_PRIORITY_LOWEST (NUM_THREAD_PRIORITIES - 1u)
+
+// Timeout in ticks for a wait that only ends when the thread is woken.
+#define WAIT_FOREVER 0xffffffffu
+
 enum class ThreadState : uint8_t
 {
     Created,
     Ready,
     Executing,
     Blocked,
+    Sleeping,
+    /// @brief Its process used up its CpuQuota, held in the process's throttled threads until the budget is refilled.
+    Throttled,
+    /// @brief Deadline thread that used up its job's budget, in the sleep queue until its next job is released.
+    Depleted,
     Zombie,
     Dead,
     NUM_STATES,
 };
 
+/// @brief Which part of a synchronous IPC a blocked thread is waiting in.
+enum class IpcPhase : uint8_t
+{
+    None,
+    /// @brief Waiting for the receiver to take a message.
+    Sending,
+    /// @brief Waiting for the receiver to take a message, then for its reply.
+    Calling,
+    /// @brief Waiting for a message, or for the reply to a call.
+    Receiving,
+};
+
+/// @brief How a thread competes for the CPU. Deadline threads always run ahead of priority threads.
+enum class SchedulingClass : uint8_t
+{
+    Priority,
+    Deadline,
+    NUM_CLASSES,
+};
+
 class Process;
+class KernelMutex;
+
+using namespace os::utils::linked_list;
 
 class Thread
 {
         friend class Process;
+        friend class ProcessManager;
+        friend class MutexManager;
+        friend class EventFlags;
+        friend class IpcManager;
+        friend class RegionQueue;
 
     private:
         uint32_t _threadId;
         Process* _parentProcess;
 
         ThreadState _state;
+        /// @brief Links the thread into whichever ready, blocked or sleep queue it is currently in.
+        IntrusiveListNode<Thread> _queueLink;
+        /// @brief The wait queue a blocked thread is in, so it can be removed when woken.
+        IntrusiveList<Thread, &Thread::_queueLink>* _waitQueue;
+        /// @brief Links a blocked thread into the list of waits with a timeout, while it is also in its wait queue.
+        IntrusiveListNode<Thread> _timeoutLink;
+        /// @brief Tick at which a sleeping thread should be woken, or a wait should time out.
+        uint32_t _wakeTick;
+        /// @brief What a thread waiting on event flags is waiting for.
+        uint32_t _waitMask;
+        uint32_t _waitOptions;
+        /// @brief Start of the memory region a thread waiting on a full RegionQueue is sending.
+        uintptr_t _waitRegion;
+        ThreadNotification _notification;
+        IpcPhase _ipcPhase;
+        /// @brief The thread a blocked IPC is with, or IPC_ANY_THREAD for a receive from anyone.
+        uint32_t _ipcPartner;
+        /// @brief Threads blocked sending to this one, highest priority first.
+        IntrusiveList<Thread, &Thread::_queueLink> _ipcSenders;
+
+        SchedulingClass _schedulingClass;
+        /// @brief Priority the thread is scheduled at. Raised above the base priority while it holds
+        ///        a mutex that a higher priority thread is waiting on.
+        uint8_t _priority;
+        uint8_t _basePriority;
+        /// @brief The mutex a blocked thread is waiting to acquire.
+        KernelMutex* _waitingMutex;
+        /// @brief Contended mutexes held by the thread, chained through the mutexes.
+        KernelMutex* _heldMutexes;
+        DeadlineState _deadline;
 
         bool _privileged;
         SavedRegisters _savedRegs;
         MemRegion _stack;
 
+        ThreadCpuUsage _cpuUsage;
+
     public:
+        /// @brief Queue of threads that does not allocate when threads are added or removed.
+        /// A thread can only be in one of these at a time.
+        using Queue = IntrusiveList<Thread, &Thread::_queueLink>;
+
         /// @brief Included for flexibility, not intended for actually creating threads.
         /// Use Thread::Thread(Process&) instead.
         Thread();
@@ -68,6 +150,10 @@ class Thread
         uint32_t getId() const { return _threadId; };
         Process& getProcess() const { return *_parentProcess; };
         ThreadState getState() const { return _state; };
+        SchedulingClass GetSchedulingClass() const { return _schedulingClass; };
+        uint8_t GetPriority() const { return _priority; };
+        uint8_t GetBasePriority() const { return _basePriority; };
+        const DeadlineState& GetDeadlineState() const { return _deadline; };
         bool isPrivileged() const { return _privileged; };
         AutomaticallyStackedRegisters* GetStackedRegisters() const
         {
@@ -76,6 +162,8 @@ class Thread
         };
         const SavedRegisters* GetSavedRegisters() const { return &_savedRegs; };
         void SetSavedRegisters(const SavedRegisters& savedRegs) { _savedRegs = savedRegs; }
+        const ThreadCpuUsage& GetCpuUsage() const { return _cpuUsage; };
+        ThreadCpuUsage& GetCpuUsage() { return _cpuUsage; };
 
         /// @brief Sets the entry point of the thread upon beginning execution.
         /// @param startAddress The address of the first instruction to run.
@@ -88,4 +176,6 @@ class Thread
         };
 };
 
+using ThreadQueue = Thread::Queue;
+
 #endif
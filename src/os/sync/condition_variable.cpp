@@ -0,0 +1,48 @@
+#include "condition_variable.hpp"
+#include "kernel_lock.hpp"
+#include "mutex_mgr.hpp"
+#include "proc_mgr.h"
+
+ConditionVariable::ConditionVariable()
+    : KernelObject(),
+      _waiters()
+{
+}
+
+ConditionVariable::~ConditionVariable()
+{
+    // Waiters already released their mutex, they lock it again as after a timeout.
+    KernelLock::Guard guard(schedulerLock);
+    while (!_waiters.empty())
+    {
+        processManager.WakeThread(*_waiters.front(), static_cast<uint32_t>(KernelResultStatus::Error));
+    }
+}
+
+KernelResultStatus
+ConditionVariable::Wait(uint32_t core, volatile uint32_t* const mutexState, const uint32_t timeoutTicks)
+{
+    Thread* newOwner = nullptr;
+    const KernelResultStatus status = mutexManager.Release(core, mutexState, newOwner);
+    if (status != KernelResultStatus::Success) return status;
+    if (timeoutTicks == 0) return KernelResultStatus::Timeout;
+
+    processManager.BlockThreadOn(core, _waiters, timeoutTicks);
+    // Returned if the wait times out, Signal replaces it.
+    return KernelResultStatus::Timeout;
+}
+
+void
+ConditionVariable::Signal(uint32_t core, const bool all, const bool fromInterrupt)
+{
+    // Waiters are in priority order, so the first one woken has the highest priority.
+    Thread* const firstWoken = _waiters.front();
+    if (firstWoken == nullptr) return;
+
+    do
+    {
+        processManager.WakeThread(*_waiters.front(), static_cast<uint32_t>(KernelResultStatus::Success));
+    } while (all && !_waiters.empty());
+
+    processManager.PreemptIfOutranked(core, *firstWoken, fromInterrupt);
+}
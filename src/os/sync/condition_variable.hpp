@@ -0,0 +1,49 @@
+#ifndef _CONDITION_VARIABLE_H
+#define _CONDITION_VARIABLE_H
+
+#include "critical_section.h"
+#include "kernel_object.hpp"
+#include "kernel_result_status.hpp"
+#include "thread.h"
+#include <cstdint>
+
+/// @brief Condition variable used with an os::sync::Mutex. Threads wait through ApiRequestId::ConditionWait,
+///        which releases the mutex and blocks in one step, so a signal between the two can't be missed.
+/// The waiter has to lock the mutex again itself once woken (see os::sync::ConditionWait).
+class ConditionVariable : public KernelObject
+{
+    private:
+        ThreadQueue _waiters;
+
+        void Signal(uint32_t core, const bool all, const bool fromInterrupt);
+
+    public:
+        ConditionVariable();
+        ConditionVariable(const ConditionVariable&) = delete;
+        ConditionVariable(ConditionVariable&&) = delete;
+        ~ConditionVariable();
+        ConditionVariable& operator=(const ConditionVariable&) = delete;
+        ConditionVariable& operator=(ConditionVariable&&) = delete;
+
+        /// @brief Release a mutex held by the running thread on a core and block it until signalled.
+        /// @param mutexState Lock word of the mutex to release.
+        /// @param timeoutTicks How long to block for. 0 doesn't block, WAIT_FOREVER never times out.
+        /// @return Success if signalled, Timeout if the wait timed out, Error if the caller doesn't hold the mutex.
+        KernelResultStatus Wait(uint32_t core, volatile uint32_t* const mutexState, const uint32_t timeoutTicks);
+        /// @brief Wake the highest priority waiter. The calling thread yields if the waiter has a higher priority.
+        void NotifyOne(uint32_t core) { Signal(core, false, false); };
+        /// @brief Wake every waiter. The calling thread yields if any of them has a higher priority.
+        void NotifyAll(uint32_t core) { Signal(core, true, false); };
+        void NotifyOneFromIsr()
+        {
+            CriticalSection critical;
+            Signal(0, false, true);
+        };
+        void NotifyAllFromIsr()
+        {
+            CriticalSection critical;
+            Signal(0, true, true);
+        };
+};
+
+#endif /* _CONDITION_VARIABLE_H */
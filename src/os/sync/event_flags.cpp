@@ -0,0 +1,79 @@
+#include "event_flags.hpp"
+#include "kernel_lock.hpp"
+#include "proc_mgr.h"
+
+EventFlags::EventFlags()
+    : KernelObject(),
+      _flags(0),
+      _waiters()
+{
+}
+
+EventFlags::~EventFlags()
+{
+    // Waiters get no flags, as if their wait timed out.
+    KernelLock::Guard guard(schedulerLock);
+    while (!_waiters.empty())
+    {
+        processManager.WakeThread(*_waiters.front(), 0);
+    }
+}
+
+uint32_t
+EventFlags::Match(const uint32_t flags, const uint32_t mask, const uint32_t options)
+{
+    const uint32_t matched = flags & mask;
+    if ((options & EVENT_FLAGS_WAIT_ALL) != 0)
+    {
+        return (matched == mask) ? matched : 0;
+    }
+    return matched;
+}
+
+uint32_t
+EventFlags::Wait(uint32_t core, const uint32_t mask, const uint32_t options, const uint32_t timeoutTicks)
+{
+    if (mask == 0) return 0;
+
+    const uint32_t matched = Match(_flags, mask, options);
+    if (matched != 0)
+    {
+        if ((options & EVENT_FLAGS_CLEAR) != 0) _flags &= ~matched;
+        return matched;
+    }
+    if (timeoutTicks == 0) return 0;
+
+    Thread& thread = *processManager.GetRunningThread(core);
+    thread._waitMask = mask;
+    thread._waitOptions = options;
+    processManager.BlockThreadOn(core, _waiters, timeoutTicks);
+    // Returned if the wait times out, Signal replaces it.
+    return 0;
+}
+
+void
+EventFlags::Signal(uint32_t core, const uint32_t flags, const bool fromInterrupt)
+{
+    _flags |= flags;
+
+    // Waiters are in priority order, so the first one woken has the highest priority.
+    Thread* firstWoken = nullptr;
+    Thread* waiter = _waiters.front();
+    while ((waiter != nullptr) && (_flags != 0))
+    {
+        Thread* const next = _waiters.next(*waiter);
+        const uint32_t matched = Match(_flags, waiter->_waitMask, waiter->_waitOptions);
+        if (matched != 0)
+        {
+            if ((waiter->_waitOptions & EVENT_FLAGS_CLEAR) != 0) _flags &= ~matched;
+            processManager.WakeThread(*waiter, matched);
+            if (firstWoken == nullptr) firstWoken = waiter;
+        }
+        waiter = next;
+    }
+
+    if (firstWoken != nullptr)
+    {
+        processManager.PreemptIfOutranked(core, *firstWoken, fromInterrupt);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef _EVENT_FLAGS_H
+#define _EVENT_FLAGS_H
+
+#include "critical_section.h"
+#include "kernel_object.hpp"
+#include "thread.h"
+#include <cstdint>
+
+// Wait until all flags in the mask are set, instead of any of them.
+#define EVENT_FLAGS_WAIT_ALL (1u << 0)
+// Clear the flags that ended the wait.
+#define EVENT_FLAGS_CLEAR (1u << 1)
+
+/// @brief Group of 32 flags that threads can wait on, for any or all of a set of flags.
+/// Threads wait through ApiRequestId::EventFlagsWait. Interrupt handlers can set flags directly with SetFromIsr.
+class EventFlags : public KernelObject
+{
+    private:
+        uint32_t _flags;
+        ThreadQueue _waiters;
+
+        /// @return The flags in the mask that satisfy the wait, or 0 if it isn't satisfied yet.
+        static uint32_t Match(const uint32_t flags, const uint32_t mask, const uint32_t options);
+        void Signal(uint32_t core, const uint32_t flags, const bool fromInterrupt);
+
+    public:
+        EventFlags();
+        EventFlags(const EventFlags&) = delete;
+        EventFlags(EventFlags&&) = delete;
+        ~EventFlags();
+        EventFlags& operator=(const EventFlags&) = delete;
+        EventFlags& operator=(EventFlags&&) = delete;
+
+        /// @brief Wait on behalf of the running thread on a core for flags to be set, blocking it until they are.
+        /// @param mask The flags to wait for.
+        /// @param options EVENT_FLAGS_* options.
+        /// @param timeoutTicks How long to block for. 0 doesn't block, WAIT_FOREVER never times out.
+        /// @return The flags in the mask that were set, 0 if the wait timed out.
+        uint32_t Wait(uint32_t core, const uint32_t mask, const uint32_t options, const uint32_t timeoutTicks);
+        /// @brief Set flags, waking every waiter they satisfy. Higher priority waiters are woken first, so they
+        ///        get to clear flags first. The calling thread yields if a waiter has a higher priority.
+        void Set(uint32_t core, const uint32_t flags) { Signal(core, flags, false); };
+        /// @brief Same as Set, from an interrupt handler. Takes time linear in the number of waiters.
+        void SetFromIsr(const uint32_t flags)
+        {
+            CriticalSection critical;
+            Signal(0, flags, true);
+        };
+        void Clear(const uint32_t flags) { _flags &= ~flags; };
+        uint32_t Get() const { return _flags; };
+};
+
+#endif /* _EVENT_FLAGS_H */
@@ -0,0 +1,42 @@
+#include "kernel_lock.hpp"
+#include "dwt.h"
+
+KernelLock schedulerLock{KERNEL_INTERRUPT_CEILING};
+KernelLock processLock{KERNEL_REQUEST_CEILING};
+KernelLock memoryLock{KERNEL_REQUEST_CEILING};
+KernelLock ipcLock{KERNEL_REQUEST_CEILING};
+
+static_assert(KERNEL_INTERRUPT_CEILING <= KERNEL_REQUEST_CEILING, "The scheduler lock must hold off everything the others do");
+
+KernelLock::KernelLock(const uint32_t ceiling)
+    : _ceiling(ceiling),
+      _depth(0),
+      _previousBasePri(0),
+      _acquiredCycles(0),
+      _maxHeldCycles(0)
+{
+}
+
+KernelLock::~KernelLock()
+{
+    // Intentionally do nothing.
+}
+
+void
+KernelLock::Acquire()
+{
+    const uint32_t previous = enter_critical_section(_ceiling);
+    // Only the holder can get here while the lock is held, everything else that takes it is masked.
+    if (_depth++ > 0) return;
+    _previousBasePri = previous;
+    _acquiredCycles = DWT->get_cycle_count();
+}
+
+void
+KernelLock::Release()
+{
+    if (--_depth > 0) return;
+    const uint32_t held = DWT->get_cycle_count() - _acquiredCycles;
+    if (held > _maxHeldCycles) _maxHeldCycles = held;
+    exit_critical_section(_previousBasePri);
+}
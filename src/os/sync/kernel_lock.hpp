@@ -0,0 +1,77 @@
+#ifndef _KERNEL_LOCK_H
+#define _KERNEL_LOCK_H
+
+#include "critical_section.h"
+#include "interrupt_priorities.h"
+#include <cstdint>
+
+/* Kernel locks. Requests can be preempted by interrupt handlers, so each part of the kernel's state is guarded by
+ * the lock of the subsystem that owns it, and only for as long as it is being changed.
+ * A lock raises BASEPRI to its ceiling, the most urgent priority of anything else that takes it. Nothing that
+ * could take a held lock can run, so a lock is never waited for and locks can nest in any order.
+ *   schedulerLock  Thread queues, sync objects and notifications. Interrupt handlers reach these through the
+ *                  *FromIsr calls, so it holds off every handler that uses the kernel, like CriticalSection.
+ *   processLock    The process table.
+ *   memoryLock     Pages, shared memory and process memory regions.
+ *   ipcLock        IPC partners and region queues.
+ * The last three are only used by requests and kernel threads. They hold off requests and thread switches but no
+ * interrupt handler. Requests already run at that priority, they matter for kernel threads such as the worker.
+ * Never make a request while holding a lock, an SVC can't be taken with BASEPRI at or above its priority.
+ * The locks only let interrupt handlers preempt requests, not threads. A request runs in handler mode at PendSV's
+ * level, so a more urgent thread it or a handler wakes only runs once the request returns. Thread latency is
+ * bounded by the longest request handler, long work belongs on a kernel thread such as the async worker.
+ */
+class KernelLock
+{
+    private:
+        const uint32_t _ceiling;
+        uint32_t _depth;
+        uint32_t _previousBasePri;
+        uint32_t _acquiredCycles;
+        uint32_t _maxHeldCycles;
+
+    public:
+        /// @param ceiling BASEPRI to raise to while held.
+        explicit KernelLock(const uint32_t ceiling);
+        KernelLock(const KernelLock&) = delete;
+        KernelLock(KernelLock&&) = delete;
+        ~KernelLock();
+        KernelLock& operator=(const KernelLock&) = delete;
+        KernelLock& operator=(KernelLock&&) = delete;
+
+        /// @brief Take the lock. Can be taken again by the holder, each Acquire needs a Release.
+        void Acquire();
+        void Release();
+        /// @return The longest the lock has been held for, in cycles. This bounds the latency it adds to anything it holds off.
+        uint32_t GetMaxHeldCycles() const { return _maxHeldCycles; };
+
+        /// @brief Holds a lock for as long as it is in scope.
+        class Guard
+        {
+            private:
+                KernelLock& _lock;
+
+            public:
+                explicit Guard(KernelLock& lock)
+                    : _lock(lock)
+                {
+                    _lock.Acquire();
+                }
+
+                Guard(const Guard&) = delete;
+                Guard(Guard&&) = delete;
+                ~Guard()
+                {
+                    _lock.Release();
+                }
+                Guard& operator=(const Guard&) = delete;
+                Guard& operator=(Guard&&) = delete;
+        };
+};
+
+extern KernelLock schedulerLock;
+extern KernelLock processLock;
+extern KernelLock memoryLock;
+extern KernelLock ipcLock;
+
+#endif /* _KERNEL_LOCK_H */
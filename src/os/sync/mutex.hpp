@@ -0,0 +1,90 @@
+#ifndef _MUTEX_H
+#define _MUTEX_H
+
+#include "exclusive_access.h"
+#include "kernel_result_status.hpp"
+#include "libos.hpp"
+#include <cstdint>
+
+// Value of the lock word when nobody holds the mutex. Otherwise it holds the owner's thread ID.
+#define MUTEX_UNLOCKED 0u
+// Set in the lock word by the kernel when threads are waiting, so the owner has to unlock through the kernel.
+#define MUTEX_CONTENDED (1u << 31)
+#define MUTEX_OWNER_MASK (~MUTEX_CONTENDED)
+
+namespace os::sync
+{
+    /// @brief Mutex with priority inheritance, for threads to use directly.
+    /// Uncontended locking and unlocking is done in the calling thread without entering the kernel.
+    /// Only when the mutex is held by another thread does the caller trap into the kernel to wait for it,
+    /// raising the owner's priority to its own while it waits.
+    /// @remark Not recursive. Callers identify themselves with their thread ID (ApiRequestId::GetThreadId).
+    class Mutex
+    {
+        private:
+            volatile uint32_t _state;
+
+        public:
+            Mutex()
+                : _state(MUTEX_UNLOCKED)
+            {
+            }
+
+            // The kernel identifies the mutex by the address of its lock word, so it can't be copied or moved.
+            Mutex(const Mutex&) = delete;
+            Mutex(Mutex&&) = delete;
+            ~Mutex()
+            {
+                // Nothing to release, the kernel only keeps state while threads are waiting.
+            }
+            Mutex& operator=(const Mutex&) = delete;
+            Mutex& operator=(Mutex&&) = delete;
+
+            /// @brief The word the kernel identifies the mutex by.
+            volatile uint32_t* GetLockWord() { return &_state; };
+
+            /// @brief Take the mutex if nobody holds it, without waiting.
+            /// @param threadId The calling thread's ID.
+            /// @return Whether the mutex was taken.
+            bool TryLock(const uint32_t threadId)
+            {
+                do
+                {
+                    if (load_exclusive(&_state) != MUTEX_UNLOCKED)
+                    {
+                        clear_exclusive();
+                        return false;
+                    }
+                } while (!store_exclusive(&_state, threadId));
+                return true;
+            }
+
+            /// @brief Take the mutex, waiting in the kernel if another thread holds it.
+            /// @param threadId The calling thread's ID.
+            /// @return Error if the caller already holds the mutex or the kernel couldn't track the wait.
+            KernelResultStatus Lock(const uint32_t threadId)
+            {
+                if (TryLock(threadId)) return KernelResultStatus::Success;
+                return os::libos::LockMutex(&_state);
+            }
+
+            /// @brief Release the mutex, handing it to the highest priority waiter if there is one.
+            /// @param threadId The calling thread's ID.
+            /// @return Error if the caller doesn't hold the mutex.
+            KernelResultStatus Unlock(const uint32_t threadId)
+            {
+                do
+                {
+                    if (load_exclusive(&_state) != threadId)
+                    {
+                        // Contended (or not ours), let the kernel sort it out.
+                        clear_exclusive();
+                        return os::libos::UnlockMutex(&_state);
+                    }
+                } while (!store_exclusive(&_state, MUTEX_UNLOCKED));
+                return KernelResultStatus::Success;
+            }
+    };
+}
+
+#endif /* _MUTEX_H */
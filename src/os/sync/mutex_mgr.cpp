@@ -0,0 +1,192 @@
+#include "mutex_mgr.hpp"
+#include "mutex.hpp"
+#include "proc_mgr.h"
+
+MutexManager mutexManager;
+
+KernelMutex::KernelMutex()
+    : _state(nullptr),
+      _owner(nullptr),
+      _waiters(),
+      _nextHeld(nullptr)
+{
+}
+
+KernelMutex::~KernelMutex()
+{
+    // Intentionally do nothing.
+}
+
+MutexManager::MutexManager()
+    : _mutexes()
+{
+}
+
+MutexManager::~MutexManager()
+{
+    // Intentionally do nothing.
+}
+
+KernelMutex*
+MutexManager::Find(volatile uint32_t* const state)
+{
+    for (KernelMutex& mutex : _mutexes)
+    {
+        if (mutex._state == state) return &mutex;
+    }
+    return nullptr;
+}
+
+KernelMutex*
+MutexManager::Allocate(volatile uint32_t* const state, Thread& owner)
+{
+    // Unused entries have no lock word.
+    KernelMutex* const mutex = Find(nullptr);
+    if (mutex == nullptr) return nullptr;
+
+    mutex->_state = state;
+    mutex->_owner = &owner;
+    AddHeldMutex(owner, *mutex);
+    return mutex;
+}
+
+void
+MutexManager::Free(KernelMutex& mutex)
+{
+    mutex._state = nullptr;
+    mutex._owner = nullptr;
+}
+
+void
+MutexManager::AddHeldMutex(Thread& thread, KernelMutex& mutex)
+{
+    mutex._nextHeld = thread._heldMutexes;
+    thread._heldMutexes = &mutex;
+}
+
+void
+MutexManager::RemoveHeldMutex(Thread& thread, KernelMutex& mutex)
+{
+    KernelMutex** link = &thread._heldMutexes;
+    while ((*link != nullptr) && (*link != &mutex))
+    {
+        link = &(*link)->_nextHeld;
+    }
+    if (*link != nullptr) *link = mutex._nextHeld;
+    mutex._nextHeld = nullptr;
+}
+
+void
+MutexManager::UpdatePriority(Thread& thread)
+{
+    Thread* current = &thread;
+    for (unsigned depth = 0; (current != nullptr) && (depth < MUTEX_PRIORITY_CHAIN_MAX); depth++)
+    {
+        // Lower number is higher priority. Waiters are sorted, so the first one has the highest.
+        uint8_t priority = current->_basePriority;
+        for (KernelMutex* mutex = current->_heldMutexes; mutex != nullptr; mutex = mutex->_nextHeld)
+        {
+            const Thread* const waiter = mutex->_waiters.front();
+            if (waiter == nullptr) continue;
+            const uint8_t waiterPriority = ProcessManager::GetSchedulingRank(*waiter);
+            if (waiterPriority < priority) priority = waiterPriority;
+        }
+
+        if (priority == current->_priority) return;
+        processManager.SetThreadPriority(*current, priority);
+
+        // If this thread is waiting too, the owner it waits on may need to inherit the change.
+        current = (current->_waitingMutex != nullptr) ? current->_waitingMutex->_owner : nullptr;
+    }
+}
+
+KernelResultStatus
+MutexManager::Lock(uint32_t core, volatile uint32_t* const state)
+{
+    Thread& caller = *processManager.GetRunningThread(core);
+
+    // The thread was interrupted on its way here, so the owner may have released it in the meantime.
+    const uint32_t value = *state;
+    if (value == MUTEX_UNLOCKED)
+    {
+        *state = caller.getId();
+        return KernelResultStatus::Success;
+    }
+    if ((value & MUTEX_OWNER_MASK) == caller.getId()) return KernelResultStatus::Error;
+
+    KernelMutex* mutex = Find(state);
+    if (mutex == nullptr)
+    {
+        // First waiter, the owner took it without the kernel knowing.
+        Thread* const owner = processManager.FindThread(value & MUTEX_OWNER_MASK);
+        if (owner == nullptr) return KernelResultStatus::Error;
+        mutex = Allocate(state, *owner);
+        if (mutex == nullptr) return KernelResultStatus::Error;
+    }
+
+    // The owner can no longer unlock without the kernel, since it has to hand over to a waiter.
+    *state = value | MUTEX_CONTENDED;
+    caller._waitingMutex = mutex;
+    processManager.BlockThreadOn(core, mutex->_waiters);
+    UpdatePriority(*mutex->_owner);
+
+    // Returned once the caller has been handed the mutex.
+    return KernelResultStatus::Success;
+}
+
+KernelResultStatus
+MutexManager::Unlock(uint32_t core, volatile uint32_t* const state)
+{
+    Thread* next = nullptr;
+    const KernelResultStatus status = Release(core, state, next);
+    if (next != nullptr)
+    {
+        processManager.PreemptIfOutranked(core, *next, false);
+    }
+    return status;
+}
+
+KernelResultStatus
+MutexManager::Release(uint32_t core, volatile uint32_t* const state, Thread*& newOwner)
+{
+    Thread& caller = *processManager.GetRunningThread(core);
+    newOwner = nullptr;
+    const uint32_t value = *state;
+    if ((value & MUTEX_OWNER_MASK) != caller.getId()) return KernelResultStatus::Error;
+
+    KernelMutex* const mutex = Find(state);
+    Thread* const next = (mutex != nullptr) ? mutex->_waiters.front() : nullptr;
+    if (next == nullptr)
+    {
+        if (mutex != nullptr)
+        {
+            RemoveHeldMutex(caller, *mutex);
+            Free(*mutex);
+        }
+        *state = MUTEX_UNLOCKED;
+        return KernelResultStatus::Success;
+    }
+
+    // Hand the mutex straight to the highest priority waiter, so a lower priority thread can't take it first.
+    RemoveHeldMutex(caller, *mutex);
+    processManager.WakeThread(*next);
+    next->_waitingMutex = nullptr;
+    if (mutex->_waiters.empty())
+    {
+        // Uncontended again, the new owner can unlock without the kernel.
+        Free(*mutex);
+        *state = next->getId();
+    }
+    else
+    {
+        mutex->_owner = next;
+        AddHeldMutex(*next, *mutex);
+        *state = next->getId() | MUTEX_CONTENDED;
+        UpdatePriority(*next);
+    }
+
+    // Drop anything inherited through this mutex.
+    UpdatePriority(caller);
+    newOwner = next;
+    return KernelResultStatus::Success;
+}
@@ -0,0 +1,80 @@
+#ifndef _MUTEX_MGR_H
+#define _MUTEX_MGR_H
+
+#include "kernel_result_status.hpp"
+#include "thread.h"
+#include <cstdint>
+
+// Number of mutexes that can have waiting threads at the same time.
+#define MAX_CONTENDED_MUTEXES 16
+// How far priority is passed on through owners that are themselves waiting on a mutex. Also stops deadlock cycles.
+#define MUTEX_PRIORITY_CHAIN_MAX 8
+
+/// @brief Kernel side of a contended mutex: who holds it and who is waiting for it.
+/// Only exists while the mutex has waiters, uncontended mutexes are just their lock word.
+class KernelMutex
+{
+        friend class MutexManager;
+
+    private:
+        /// @brief The lock word identifying the mutex, nullptr while this entry is unused.
+        volatile uint32_t* _state;
+        Thread* _owner;
+        /// @brief Waiting threads, highest priority first.
+        ThreadQueue _waiters;
+        /// @brief Next contended mutex held by the same owner.
+        KernelMutex* _nextHeld;
+
+    public:
+        KernelMutex();
+        KernelMutex(const KernelMutex&) = delete;
+        KernelMutex(KernelMutex&&) = delete;
+        ~KernelMutex();
+        KernelMutex& operator=(const KernelMutex&) = delete;
+        KernelMutex& operator=(KernelMutex&&) = delete;
+};
+
+/// @brief Handles the slow path of @see{os::sync::Mutex}: waiting for a held mutex, handing it over on unlock,
+///        and priority inheritance.
+class MutexManager
+{
+    private:
+        KernelMutex _mutexes[MAX_CONTENDED_MUTEXES];
+
+        KernelMutex* Find(volatile uint32_t* const state);
+        KernelMutex* Allocate(volatile uint32_t* const state, Thread& owner);
+        void Free(KernelMutex& mutex);
+        void AddHeldMutex(Thread& thread, KernelMutex& mutex);
+        void RemoveHeldMutex(Thread& thread, KernelMutex& mutex);
+        /// @brief Recalculate the priority of a thread from its base priority and the waiters on its mutexes,
+        ///        then pass any change on to the owner of the mutex it is waiting on.
+        void UpdatePriority(Thread& thread);
+
+    public:
+        MutexManager();
+        MutexManager(const MutexManager&) = delete;
+        MutexManager(MutexManager&&) = delete;
+        ~MutexManager();
+        MutexManager& operator=(const MutexManager&) = delete;
+        MutexManager& operator=(MutexManager&&) = delete;
+
+        /// @brief Take a mutex for the running thread on a core, blocking it until the owner unlocks if it is held.
+        /// @param core The core the caller is running on.
+        /// @param state The mutex's lock word.
+        /// @return Error if the caller already holds the mutex, or too many mutexes are contended.
+        ///         Success once the caller holds the mutex.
+        KernelResultStatus Lock(uint32_t core, volatile uint32_t* const state);
+        /// @brief Release a mutex held by the running thread on a core, handing it to the highest priority waiter.
+        /// The caller yields if the new owner has a higher priority.
+        /// @param core The core the caller is running on.
+        /// @param state The mutex's lock word.
+        /// @return Error if the caller doesn't hold the mutex.
+        KernelResultStatus Unlock(uint32_t core, volatile uint32_t* const state);
+        /// @brief Same as Unlock, without yielding. For a caller that is about to block anyway.
+        /// @param newOwner Set to the waiter the mutex was handed to, or nullptr if there was none.
+        KernelResultStatus Release(uint32_t core, volatile uint32_t* const state, Thread*& newOwner);
+};
+
+extern MutexManager mutexManager;
+
+#endif /* _MUTEX_MGR_H */
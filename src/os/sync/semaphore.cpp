@@ -0,0 +1,53 @@
+#include "semaphore.hpp"
+#include "kernel_lock.hpp"
+#include "proc_mgr.h"
+
+Semaphore::Semaphore(const uint32_t initialCount, const uint32_t maxCount)
+    : KernelObject(),
+      _count(initialCount),
+      _maxCount(maxCount),
+      _waiters()
+{
+}
+
+Semaphore::~Semaphore()
+{
+    // The last handle was closed while threads of another handle's process still waited.
+    KernelLock::Guard guard(schedulerLock);
+    while (!_waiters.empty())
+    {
+        processManager.WakeThread(*_waiters.front(), static_cast<uint32_t>(KernelResultStatus::Error));
+    }
+}
+
+KernelResultStatus
+Semaphore::Wait(uint32_t core, const uint32_t timeoutTicks)
+{
+    if (_count > 0)
+    {
+        _count--;
+        return KernelResultStatus::Success;
+    }
+    if (timeoutTicks == 0) return KernelResultStatus::Timeout;
+
+    processManager.BlockThreadOn(core, _waiters, timeoutTicks);
+    // Returned if the wait times out, Signal replaces it.
+    return KernelResultStatus::Timeout;
+}
+
+KernelResultStatus
+Semaphore::Signal(uint32_t core, const bool fromInterrupt)
+{
+    Thread* const waiter = _waiters.front();
+    if (waiter == nullptr)
+    {
+        if (_count >= _maxCount) return KernelResultStatus::Error;
+        _count++;
+        return KernelResultStatus::Success;
+    }
+
+    // Hand the unit straight to the waiter, so the count never goes up with threads still waiting.
+    processManager.WakeThread(*waiter, static_cast<uint32_t>(KernelResultStatus::Success));
+    processManager.PreemptIfOutranked(core, *waiter, fromInterrupt);
+    return KernelResultStatus::Success;
+}
@@ -0,0 +1,48 @@
+#ifndef _SEMAPHORE_H
+#define _SEMAPHORE_H
+
+#include "critical_section.h"
+#include "kernel_object.hpp"
+#include "kernel_result_status.hpp"
+#include "thread.h"
+#include <cstdint>
+
+/// @brief Counting semaphore. Threads wait through ApiRequestId::SemaphoreWait, highest priority first.
+/// Interrupt handlers can post directly with PostFromIsr.
+class Semaphore : public KernelObject
+{
+    private:
+        uint32_t _count;
+        uint32_t _maxCount;
+        ThreadQueue _waiters;
+
+        KernelResultStatus Signal(uint32_t core, const bool fromInterrupt);
+
+    public:
+        /// @param initialCount Number of waits that succeed straight away.
+        /// @param maxCount Posts beyond this count with nobody waiting fail.
+        Semaphore(const uint32_t initialCount, const uint32_t maxCount);
+        Semaphore(const Semaphore&) = delete;
+        Semaphore(Semaphore&&) = delete;
+        ~Semaphore();
+        Semaphore& operator=(const Semaphore&) = delete;
+        Semaphore& operator=(Semaphore&&) = delete;
+
+        /// @brief Take a unit for the running thread on a core, blocking it if there are none.
+        /// @param timeoutTicks How long to block for. 0 doesn't block, WAIT_FOREVER never times out.
+        /// @return Success if a unit was taken, Timeout if none was available in time.
+        KernelResultStatus Wait(uint32_t core, const uint32_t timeoutTicks);
+        /// @brief Give a unit to the first waiter, or add it to the count if nobody is waiting.
+        /// The calling thread yields if the waiter has a higher priority.
+        /// @return Error if the count is already at its maximum.
+        KernelResultStatus Post(uint32_t core) { return Signal(core, false); };
+        /// @brief Same as Post, from an interrupt handler. Constant time.
+        KernelResultStatus PostFromIsr()
+        {
+            CriticalSection critical;
+            return Signal(0, true);
+        };
+        uint32_t GetCount() const { return _count; };
+};
+
+#endif /* _SEMAPHORE_H */
@@ -0,0 +1,128 @@
+#ifndef _SYNC_API_H
+#define _SYNC_API_H
+
+#include "condition_variable.hpp"
+#include "event_flags.hpp"
+#include "kernel_result_status.hpp"
+#include "libos.hpp"
+#include "mutex.hpp"
+#include "semaphore.hpp"
+#include <cstdint>
+
+/* Thread-side calls for the blocking primitives. The objects themselves live in kernel memory,
+ * threads name them by the handles the kernel gave their process, see HandleTable.
+ * Requests on a handle that is stale, names another kind of object or lacks the rights fail with Error.
+ * Timeouts are in ticks, see WAIT_FOREVER.
+ */
+namespace os::sync
+{
+    /// @return A handle with every right to a new semaphore, HANDLE_NONE if it can't be made.
+    inline Handle
+    CreateSemaphore(const uint32_t initialCount, const uint32_t maxCount)
+    {
+        return os::libos::CreateSemaphore(initialCount, maxCount);
+    }
+
+    /// @return A handle with every right to new, all clear, event flags. HANDLE_NONE if they can't be made.
+    inline Handle
+    CreateEventFlags()
+    {
+        return os::libos::CreateEventFlags();
+    }
+
+    /// @return A handle with every right to a new condition variable, HANDLE_NONE if it can't be made.
+    inline Handle
+    CreateConditionVariable()
+    {
+        return os::libos::CreateConditionVariable();
+    }
+
+    inline KernelResultStatus
+    SemaphoreWait(const Handle semaphore, const uint32_t timeoutTicks = WAIT_FOREVER)
+    {
+        return os::libos::SemaphoreWait(semaphore, timeoutTicks);
+    }
+
+    inline KernelResultStatus
+    SemaphorePost(const Handle semaphore)
+    {
+        return os::libos::SemaphorePost(semaphore);
+    }
+
+    /// @return The flags that ended the wait, 0 if it timed out or the handle is unusable.
+    inline uint32_t
+    EventFlagsWait(const Handle flags, const uint32_t mask, const uint32_t options, const uint32_t timeoutTicks = WAIT_FOREVER)
+    {
+        return os::libos::EventFlagsWait(flags, mask, options, timeoutTicks);
+    }
+
+    inline KernelResultStatus
+    EventFlagsSet(const Handle flags, const uint32_t toSet)
+    {
+        return os::libos::EventFlagsSet(flags, toSet);
+    }
+
+    inline KernelResultStatus
+    EventFlagsClear(const Handle flags, const uint32_t toClear)
+    {
+        return os::libos::EventFlagsClear(flags, toClear);
+    }
+
+    /// @brief Release the mutex and wait to be notified, then lock it again.
+    /// @return Success if notified, Timeout if the wait timed out, Error if the caller didn't hold the mutex.
+    ///         The mutex is held again either way, unless it wasn't held to begin with.
+    inline KernelResultStatus
+    ConditionWait(const Handle condition, Mutex& mutex, const uint32_t threadId, const uint32_t timeoutTicks = WAIT_FOREVER)
+    {
+        const KernelResultStatus status = os::libos::ConditionWait(condition, mutex.GetLockWord(), timeoutTicks);
+        if (status != KernelResultStatus::Error) mutex.Lock(threadId);
+        return status;
+    }
+
+    inline KernelResultStatus
+    ConditionNotifyOne(const Handle condition)
+    {
+        return os::libos::ConditionNotifyOne(condition);
+    }
+
+    inline KernelResultStatus
+    ConditionNotifyAll(const Handle condition)
+    {
+        return os::libos::ConditionNotifyAll(condition);
+    }
+
+    /// @brief Give up a handle. The object is destroyed with the last handle to it, and threads still waiting on it
+    ///        are woken as if their wait had failed.
+    inline KernelResultStatus
+    CloseHandle(const Handle handle)
+    {
+        return os::libos::CloseHandle(handle);
+    }
+
+    /// @brief Give another process a handle to the same object, e.g. to share a semaphore with a server.
+    /// @param rights Rights for the new handle, at most those of the original, which must include Duplicate.
+    /// @return The new handle, only meaningful to the other process. HANDLE_NONE if it can't be made.
+    inline Handle
+    DuplicateHandle(const Handle handle, const uint32_t processId, const HandleRights rights)
+    {
+        return os::libos::DuplicateHandle(handle, processId, rights);
+    }
+
+    /// @return Error if there is no thread with that ID.
+    inline KernelResultStatus
+    NotifyThread(const uint32_t threadId, const NotifyAction action, const uint32_t value = 0)
+    {
+        return os::libos::NotifyThread(threadId, action, value);
+    }
+
+    /// @brief Wait for the calling thread to be notified.
+    /// @param clearBits Bits of the notification value to clear once taken. All of them consumes every notification.
+    /// @return The notification value, 0 if the wait timed out.
+    inline uint32_t
+    WaitForNotification(const uint32_t clearBits = 0xffffffffu, const uint32_t timeoutTicks = WAIT_FOREVER)
+    {
+        return os::libos::WaitForNotification(clearBits, timeoutTicks);
+    }
+}
+
+#endif /* _SYNC_API_H */
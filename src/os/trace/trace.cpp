@@ -0,0 +1,54 @@
+#include "trace.hpp"
+#include "format.h"
+#include "usart_driver.h"
+
+using namespace os::utils::format;
+
+// Timestamp, type, core, thread, arg, separated by spaces.
+#define TRACE_LINE_LENGTH (8 + 1 + 2 + 1 + 2 + 1 + 4 + 1 + 8 + 1)
+
+#ifdef KERNEL_TRACE
+
+TraceBuffer traceBuffer = {TRACE_BUFFER_MAGIC, TRACE_BUFFER_ENTRIES, 0, {}};
+
+bool
+TraceDump(const usart_t usart)
+{
+    static const char header[] = "trace begin\n";
+    static const char footer[] = "trace end\n";
+
+    // Events recorded while dumping (e.g. the request that asked for the dump) are left for the next dump.
+    const uint32_t head = traceBuffer.Head;
+    const uint32_t numEvents = (head < TRACE_BUFFER_ENTRIES) ? head : TRACE_BUFFER_ENTRIES;
+
+    char line[TRACE_LINE_LENGTH];
+    usart_send_string(usart, header, sizeof(header) - 1);
+    for (uint32_t i = head - numEvents; i != head; i++)
+    {
+        const TraceEvent& event = traceBuffer.Events[i & (TRACE_BUFFER_ENTRIES - 1)];
+        size_t length = 0;
+        length += FormatHex(line + length, TRACE_LINE_LENGTH - length, event.Timestamp, 8);
+        length += FormatString(line + length, TRACE_LINE_LENGTH - length, " ", 1);
+        length += FormatHex(line + length, TRACE_LINE_LENGTH - length, static_cast<uint8_t>(event.Type), 2);
+        length += FormatString(line + length, TRACE_LINE_LENGTH - length, " ", 1);
+        length += FormatHex(line + length, TRACE_LINE_LENGTH - length, event.Core, 2);
+        length += FormatString(line + length, TRACE_LINE_LENGTH - length, " ", 1);
+        length += FormatHex(line + length, TRACE_LINE_LENGTH - length, event.ThreadId, 4);
+        length += FormatString(line + length, TRACE_LINE_LENGTH - length, " ", 1);
+        length += FormatHex(line + length, TRACE_LINE_LENGTH - length, event.Arg, 8);
+        length += FormatString(line + length, TRACE_LINE_LENGTH - length, "\n", 1);
+        usart_send_string(usart, line, static_cast<uint8_t>(length));
+    }
+    usart_send_string(usart, footer, sizeof(footer) - 1);
+    return true;
+}
+
+#else
+
+bool
+TraceDump(const usart_t)
+{
+    return false;
+}
+
+#endif /* KERNEL_TRACE */
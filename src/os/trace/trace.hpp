@@ -0,0 +1,108 @@
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include "critical_section.h"
+#include "dwt.h"
+#include "stm32_usart.h"
+#include <cstdint>
+
+/* Scheduler event trace.
+ * Only compiled in when KERNEL_TRACE is defined (see the top-level Makefile), otherwise recording is a no-op.
+ * Events go into a ring buffer in RAM that overwrites the oldest entries. It can be read out with gdb
+ * or written to the USART, then converted to Chrome trace JSON by scripts/trace_to_chrome.py.
+ * The buffer layout is read by that script, keep the two in sync.
+ */
+
+// Must be a power of 2, so the ring index is a mask instead of a division.
+#define TRACE_BUFFER_ENTRIES 512u
+// Marks the start of the buffer, so the host script can tell it found the right memory.
+#define TRACE_BUFFER_MAGIC 0x54524345u
+
+enum class TraceEventType : uint8_t
+{
+    /// @brief Thread is the thread switched to, Arg is the thread switched out.
+    ContextSwitch,
+    /// @brief Thread was made ready to run, Arg is the ThreadState it was woken from.
+    Wake,
+    /// @brief Thread stopped being runnable, Arg is the ThreadState it is now in.
+    Block,
+    /// @brief Arg is the exception number.
+    IrqEnter,
+    /// @brief Arg is the exception number.
+    IrqExit,
+    /// @brief Arg is the ApiRequestId.
+    SyscallEnter,
+    /// @brief Arg is the value returned to the caller.
+    SyscallExit,
+    NUM_TYPES,
+};
+
+class TraceEvent
+{
+    public:
+        /// @brief CYCCNT when the event was recorded.
+        uint32_t Timestamp;
+        TraceEventType Type;
+        uint8_t Core;
+        uint16_t ThreadId;
+        uint32_t Arg;
+};
+
+class TraceBuffer
+{
+    public:
+        uint32_t Magic;
+        uint32_t NumEntries;
+        /// @brief Total number of events recorded. The next event goes at Head % NumEntries.
+        uint32_t Head;
+        TraceEvent Events[TRACE_BUFFER_ENTRIES];
+};
+
+#ifdef KERNEL_TRACE
+
+extern TraceBuffer traceBuffer;
+
+/// @brief Record an event in the trace buffer. Safe to call from the kernel and from interrupts that may use it.
+__attribute__((always_inline)) inline void
+TraceRecord(const TraceEventType type, const uint32_t threadId, const uint32_t arg)
+{
+    // Claiming a slot has to be atomic against interrupts, a short critical section is cheaper than an LDREX/STREX loop.
+    CriticalSection critical;
+    TraceEvent& event = traceBuffer.Events[traceBuffer.Head++ & (TRACE_BUFFER_ENTRIES - 1)];
+    event.Timestamp = DWT->get_cycle_count();
+    event.Type = type;
+    event.Core = 0;
+    event.ThreadId = static_cast<uint16_t>(threadId);
+    event.Arg = arg;
+}
+
+/// @brief Get the number of the exception being handled, to tag IRQ events with.
+__attribute__((always_inline)) inline uint32_t
+TraceGetExceptionNumber()
+{
+    uint32_t ipsr;
+    asm volatile("MRS    %[ipsr], IPSR\n\t"
+                 : [ipsr] "=r"(ipsr));
+    return ipsr;
+}
+
+#else
+
+__attribute__((always_inline)) inline void
+TraceRecord(const TraceEventType, const uint32_t, const uint32_t)
+{
+}
+
+__attribute__((always_inline)) inline uint32_t
+TraceGetExceptionNumber()
+{
+    return 0;
+}
+
+#endif /* KERNEL_TRACE */
+
+/// @brief Write the events in the trace buffer to a USART, oldest first, one hex-encoded event per line.
+/// @return Whether tracing is compiled in.
+bool TraceDump(const usart_t usart);
+
+#endif /* _TRACE_H */
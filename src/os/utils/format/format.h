@@ -0,0 +1,106 @@
+#ifndef _FORMAT_H
+#define _FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+/* Minimal text formatting for kernel reports written to the USART.
+ * libgcc isn't linked, so there is no 64-bit division - anything that would need it is done by hand here.
+ */
+namespace os::utils::format
+{
+    /// @brief Divide a 64-bit value in place using shift-and-subtract.
+    /// @param value The dividend, replaced by the quotient.
+    /// @param divisor The divisor, must not be 0.
+    /// @return The remainder.
+    inline uint32_t
+    DivideInPlace(uint64_t& value, const uint32_t divisor)
+    {
+        uint64_t dividend = value;
+        uint64_t quotient = 0;
+        uint64_t remainder = 0;
+        for (unsigned i = 0; i < 64; i++)
+        {
+            remainder = (remainder << 1) | (dividend >> 63);
+            dividend <<= 1;
+            quotient <<= 1;
+            if (remainder >= divisor)
+            {
+                remainder -= divisor;
+                quotient |= 1;
+            }
+        }
+        value = quotient;
+        return static_cast<uint32_t>(remainder);
+    }
+
+    /// @brief Write a number in decimal, right-aligned in a field.
+    /// @param dest Buffer to write to.
+    /// @param destSize Space left in the buffer.
+    /// @param value The number to write.
+    /// @param width Minimum number of characters to write, padded with spaces on the left.
+    /// @return The number of characters written.
+    inline size_t
+    FormatUnsigned(char* const dest, const size_t destSize, uint64_t value, const size_t width)
+    {
+        // 2^64 has 20 digits.
+        char digits[20];
+        size_t numDigits = 0;
+        do
+        {
+            digits[numDigits++] = static_cast<char>('0' + DivideInPlace(value, 10));
+        } while (value != 0);
+
+        size_t written = 0;
+        for (size_t pad = numDigits; (pad < width) && (written < destSize); pad++)
+        {
+            dest[written++] = ' ';
+        }
+        while ((numDigits > 0) && (written < destSize))
+        {
+            dest[written++] = digits[--numDigits];
+        }
+        return written;
+    }
+
+    /// @brief Write a number in hexadecimal with a fixed number of digits, zero-padded on the left.
+    /// @param dest Buffer to write to.
+    /// @param destSize Space left in the buffer.
+    /// @param value The number to write.
+    /// @param numDigits Number of digits to write. Higher digits of the value are dropped.
+    /// @return The number of characters written.
+    inline size_t
+    FormatHex(char* const dest, const size_t destSize, const uint32_t value, const size_t numDigits)
+    {
+        static const char hexDigits[] = "0123456789abcdef";
+        size_t written = 0;
+        for (size_t digit = numDigits; (digit > 0) && (written < destSize); digit--)
+        {
+            dest[written++] = hexDigits[(value >> ((digit - 1) * 4)) & 0xfu];
+        }
+        return written;
+    }
+
+    /// @brief Write a string, left-aligned in a field.
+    /// @param dest Buffer to write to.
+    /// @param destSize Space left in the buffer.
+    /// @param str Null-terminated string to write.
+    /// @param width Minimum number of characters to write, padded with spaces on the right.
+    /// @return The number of characters written.
+    inline size_t
+    FormatString(char* const dest, const size_t destSize, const char* str, const size_t width)
+    {
+        size_t written = 0;
+        while ((*str != '\0') && (written < destSize))
+        {
+            dest[written++] = *str++;
+        }
+        while ((written < width) && (written < destSize))
+        {
+            dest[written++] = ' ';
+        }
+        return written;
+    }
+}
+
+#endif /* _FORMAT_H */
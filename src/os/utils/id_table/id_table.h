@@ -0,0 +1,115 @@
+#ifndef _ID_TABLE_H
+#define _ID_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Low bits of an ID are the slot index, the rest the slot's generation.
+#define ID_TABLE_INDEX_BITS 8u
+#define ID_TABLE_INDEX_MASK ((1u << ID_TABLE_INDEX_BITS) - 1u)
+// Top bit is left clear, e.g. mutex lock words use it as a flag next to the owner's ID.
+#define ID_TABLE_GENERATION_MAX ((1u << (31u - ID_TABLE_INDEX_BITS)) - 1u)
+
+namespace os::utils::id_table
+{
+    /// @brief Fixed-capacity table handing out IDs for objects it doesn't own, with constant-time lookup.
+    /// An ID is a slot index tagged with the slot's generation, which moves on each time the slot is freed.
+    /// A freed ID stops finding anything, even once its slot is reused, until the generation wraps.
+    /// IDs are never 0, so 0 can mean "none".
+    /// @tparam T Stored Data Type
+    /// @tparam TCapacity Maximum number of objects at once.
+    template <class T, std::size_t TCapacity>
+    class IdTable
+    {
+            static_assert((TCapacity > 0) && (TCapacity <= (ID_TABLE_INDEX_MASK + 1u)), "Slot indices must fit the index bits");
+
+        private:
+            static constexpr std::size_t BITMAP_WORDS = (TCapacity + 31u) / 32u;
+
+            T* _entries[TCapacity];
+            uint32_t _generations[TCapacity];
+            /// @brief One bit per slot, set while it is free.
+            uint32_t _freeSlots[BITMAP_WORDS];
+
+            static uint32_t MakeId(const uint32_t generation, const uint32_t index)
+            {
+                return (generation << ID_TABLE_INDEX_BITS) | index;
+            }
+
+            /// @return The slot an ID refers to, TCapacity if it refers to none.
+            uint32_t FindSlot(const uint32_t id) const
+            {
+                const uint32_t index = id & ID_TABLE_INDEX_MASK;
+                if (index >= TCapacity) return TCapacity;
+                if ((_entries[index] == nullptr) || (_generations[index] != (id >> ID_TABLE_INDEX_BITS))) return TCapacity;
+                return index;
+            }
+
+        public:
+            IdTable()
+                : _entries(),
+                  _generations(),
+                  _freeSlots()
+            {
+                for (std::size_t i = 0; i < TCapacity; i++)
+                {
+                    _generations[i] = 1;
+                    _freeSlots[i / 32u] |= 1u << (i % 32u);
+                }
+            }
+            IdTable(const IdTable&) = delete;
+            IdTable(IdTable&&) = delete;
+            ~IdTable()
+            {
+                // Entries aren't owned, nothing to do.
+            }
+            IdTable& operator=(const IdTable&) = delete;
+            IdTable& operator=(IdTable&&) = delete;
+
+            /// @brief Give an object an ID.
+            /// @return The ID, 0 if the table is full.
+            uint32_t Allocate(T& entry)
+            {
+                for (std::size_t word = 0; word < BITMAP_WORDS; word++)
+                {
+                    if (_freeSlots[word] == 0) continue;
+                    // Lowest free slot: RBIT + CLZ.
+                    const uint32_t bit = static_cast<uint32_t>(__builtin_ctz(_freeSlots[word]));
+                    const uint32_t index = static_cast<uint32_t>(word * 32u) + bit;
+                    _freeSlots[word] &= ~(1u << bit);
+                    _entries[index] = &entry;
+                    return MakeId(_generations[index], index);
+                }
+                return 0;
+            }
+
+            /// @brief Give up an ID. Does nothing if it is stale.
+            void Free(const uint32_t id)
+            {
+                const uint32_t index = FindSlot(id);
+                if (index == TCapacity) return;
+                _entries[index] = nullptr;
+                _generations[index] = (_generations[index] == ID_TABLE_GENERATION_MAX) ? 1 : (_generations[index] + 1);
+                _freeSlots[index / 32u] |= 1u << (index % 32u);
+            }
+
+            /// @return The object with an ID, nullptr if the ID is stale or was never handed out.
+            T* Find(const uint32_t id) const
+            {
+                const uint32_t index = FindSlot(id);
+                return (index == TCapacity) ? nullptr : _entries[index];
+            }
+
+            /// @brief Call a function with each object in the table, in slot order.
+            template <typename Function>
+            void ForEach(Function function) const
+            {
+                for (std::size_t i = 0; i < TCapacity; i++)
+                {
+                    if (_entries[i] != nullptr) function(*_entries[i]);
+                }
+            }
+    };
+}
+
+#endif /* _ID_TABLE_H */
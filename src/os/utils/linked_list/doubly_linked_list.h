@@ -141,7 +141,7 @@ namespace os::utils::linked_list
             {
                 if (index >= _num_items) return T{};
 
-                details::list_item<T>* li = &_sentinel;
+                details::empty_list_item* li = _sentinel.next;
                 for (size_t i = 0; i < index; i++)
                 {
                     li = li->next;
@@ -149,8 +149,11 @@ namespace os::utils::linked_list
                     if (li == &_sentinel) return T{};
                 }
 
-                T item = li->item;
-                delete li;
+                details::list_item<T>* const item_li = reinterpret_cast<details::list_item<T>*>(li);
+                T item = item_li->item;
+                delete item_li;
+
+                _num_items--;
                 return item;
             }
 
@@ -0,0 +1,208 @@
+#ifndef _INTRUSIVE_LIST_H
+#define _INTRUSIVE_LIST_H
+
+#include <cstddef>
+
+namespace os::utils::linked_list
+{
+    template <class T>
+    class IntrusiveListNode;
+
+    /// @brief Circular Doubly-linked List whose links are embedded in the stored objects.
+    /// Unlike @see{DoublyLinkedList}, pushing and popping never allocates, so it can be used on the context switch path.
+    /// An object can only be in one list per node it embeds.
+    /// @tparam T Stored Data Type
+    /// @tparam Node The member of T used to link it into this list.
+    template <class T, IntrusiveListNode<T> T::*Node>
+    class IntrusiveList;
+
+    /// @brief Links embedded in an object so it can be stored in an @see{IntrusiveList}.
+    /// @tparam T The type of the object that contains this node.
+    template <class T>
+    class IntrusiveListNode
+    {
+            template <class U, IntrusiveListNode<U> U::*Node>
+            friend class IntrusiveList;
+
+        private:
+            IntrusiveListNode* _prev;
+            IntrusiveListNode* _next;
+            T* _owner;
+
+            void insertBetween(IntrusiveListNode* const prev, IntrusiveListNode* const next)
+            {
+                _prev = prev;
+                _next = next;
+                prev->_next = this;
+                next->_prev = this;
+            }
+
+            void unlink()
+            {
+                _prev->_next = _next;
+                _next->_prev = _prev;
+                _prev = this;
+                _next = this;
+            }
+
+        public:
+            /// @brief Create a node that is not part of any object. Only used as a list sentinel.
+            IntrusiveListNode()
+                : _prev(this),
+                  _next(this),
+                  _owner(nullptr)
+            {
+            }
+
+            /// @brief Create the node embedded in an object.
+            /// @param owner The object containing this node.
+            explicit IntrusiveListNode(T& owner)
+                : _prev(this),
+                  _next(this),
+                  _owner(&owner)
+            {
+            }
+
+            // Links belong to the object they are embedded in, a copy of the object starts out unlinked.
+            IntrusiveListNode(const IntrusiveListNode&) = delete;
+            IntrusiveListNode(IntrusiveListNode&&) = delete;
+            ~IntrusiveListNode()
+            {
+                // Nothing was allocated, the owner is responsible for removing itself from any list first.
+            }
+            IntrusiveListNode& operator=(const IntrusiveListNode&) = delete;
+            IntrusiveListNode& operator=(IntrusiveListNode&&) = delete;
+
+            bool isLinked() const { return _next != this; };
+    };
+
+    template <class T, IntrusiveListNode<T> T::*Node>
+    class IntrusiveList
+    {
+        private:
+            size_t _num_items;
+            IntrusiveListNode<T> _sentinel;
+
+            static IntrusiveListNode<T>& nodeOf(T& item) { return item.*Node; };
+
+            T* ownerOf(const IntrusiveListNode<T>* const node) const
+            {
+                if (node == &_sentinel) return nullptr;
+                return node->_owner;
+            }
+
+        public:
+            class Iterator
+            {
+                private:
+                    const IntrusiveListNode<T>* _current;
+
+                public:
+                    explicit Iterator(const IntrusiveListNode<T>* const current)
+                        : _current(current)
+                    {
+                    }
+
+                    bool operator!=(const Iterator& other) const { return _current != other._current; };
+                    T& operator*() const { return *_current->_owner; };
+                    Iterator& operator++()
+                    {
+                        _current = _current->_next;
+                        return *this;
+                    }
+            };
+
+            IntrusiveList()
+                : _num_items(0),
+                  _sentinel()
+            {
+            }
+
+            // Items can only be linked into a single list at a time, so lists can't be copied.
+            IntrusiveList(const IntrusiveList&) = delete;
+            IntrusiveList(IntrusiveList&&) = delete;
+            ~IntrusiveList()
+            {
+                clear();
+            }
+            IntrusiveList& operator=(const IntrusiveList&) = delete;
+            IntrusiveList& operator=(IntrusiveList&&) = delete;
+
+            void pushFront(T& item)
+            {
+                nodeOf(item).insertBetween(&_sentinel, _sentinel._next);
+                _num_items++;
+            }
+
+            void pushBack(T& item)
+            {
+                nodeOf(item).insertBetween(_sentinel._prev, &_sentinel);
+                _num_items++;
+            }
+
+            /// @brief Insert an item directly before another item already in this list.
+            void insertBefore(T& position, T& item)
+            {
+                IntrusiveListNode<T>& positionNode = nodeOf(position);
+                nodeOf(item).insertBetween(positionNode._prev, &positionNode);
+                _num_items++;
+            }
+
+            /// @brief Insert an item before the first item for which the predicate is true, or at the back if there is none.
+            /// Used to keep lists sorted, e.g. by wake-up time.
+            template <typename Predicate>
+            void insertSorted(T& item, Predicate insertBeforeItem)
+            {
+                IntrusiveListNode<T>* node = _sentinel._next;
+                while ((node != &_sentinel) && !insertBeforeItem(*node->_owner))
+                {
+                    node = node->_next;
+                }
+                nodeOf(item).insertBetween(node->_prev, node);
+                _num_items++;
+            }
+
+            /// @return The first item, or nullptr when the list is empty.
+            T* popFront()
+            {
+                T* const item = front();
+                if (item != nullptr) remove(*item);
+                return item;
+            }
+
+            /// @return The last item, or nullptr when the list is empty.
+            T* popBack()
+            {
+                T* const item = back();
+                if (item != nullptr) remove(*item);
+                return item;
+            }
+
+            /// @brief Remove an item from this list. The item must be in this list.
+            void remove(T& item)
+            {
+                nodeOf(item).unlink();
+                _num_items--;
+            }
+
+            T* front() const { return ownerOf(_sentinel._next); };
+            T* back() const { return ownerOf(_sentinel._prev); };
+            /// @return The item after the given one, or nullptr if it is the last item.
+            T* next(T& item) const { return ownerOf(nodeOf(item)._next); };
+
+            size_t size() const { return _num_items; };
+            bool empty() const { return _num_items == 0; };
+            void clear()
+            {
+                while (!empty())
+                {
+                    popFront();
+                }
+            }
+
+            Iterator begin() const { return Iterator{_sentinel._next}; };
+            Iterator end() const { return Iterator{&_sentinel}; };
+    };
+}
+
+#endif /* _INTRUSIVE_LIST_H */
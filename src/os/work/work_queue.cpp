@@ -0,0 +1,150 @@
+#include "work_queue.hpp"
+#include "exclusive_access.h"
+#include "libos.hpp"
+#include "proc_mgr.h"
+
+#define WORK_QUEUE_MASK (WORK_QUEUE_ENTRIES - 1u)
+// Wakes the worker. Any bit will do, the worker takes them all.
+#define WORK_QUEUE_NOTIFY_BIT 1u
+
+WorkQueue workQueue;
+
+static void
+WorkerThreadEntry()
+{
+    while (true)
+    {
+        if (workQueue.RunBatch())
+        {
+            // Leftovers get picked up once threads of the same priority have had a turn.
+            os::libos::Yield();
+            continue;
+        }
+        // Anything enqueued since the queues were found empty has already set the notification, so this returns at once.
+        os::libos::WaitForNotification(0xffffffffu, WAIT_FOREVER);
+    }
+}
+
+WorkRing::WorkRing()
+    : _slots(),
+      _enqueuePosition(0),
+      _dequeuePosition(0),
+      _overflowCount(0)
+{
+    for (uint32_t i = 0; i < WORK_QUEUE_ENTRIES; i++)
+    {
+        _slots[i].Sequence = i;
+    }
+}
+
+WorkRing::~WorkRing()
+{
+    // Intentionally do nothing.
+}
+
+bool
+WorkRing::Push(const WorkFunction function, const uintptr_t argument)
+{
+    uint32_t position;
+    Slot* slot;
+    while (true)
+    {
+        position = load_exclusive(&_enqueuePosition);
+        slot = &_slots[position & WORK_QUEUE_MASK];
+        const int32_t lag = static_cast<int32_t>(slot->Sequence - position);
+        if (lag < 0)
+        {
+            // The slot still holds an item from the previous lap.
+            clear_exclusive();
+            uint32_t overflows;
+            do
+            {
+                overflows = load_exclusive(&_overflowCount);
+            } while (!store_exclusive(&_overflowCount, overflows + 1));
+            return false;
+        }
+        // A nested producer took this position and moved on, so reload. Otherwise claim it.
+        if ((lag == 0) && store_exclusive(&_enqueuePosition, position + 1)) break;
+        clear_exclusive();
+    }
+
+    slot->Function = function;
+    slot->Argument = argument;
+    slot->Sequence = position + 1;
+    return true;
+}
+
+bool
+WorkRing::Pop(WorkFunction& function, uintptr_t& argument)
+{
+    Slot& slot = _slots[_dequeuePosition & WORK_QUEUE_MASK];
+    if (slot.Sequence != _dequeuePosition + 1) return false;
+
+    function = slot.Function;
+    argument = slot.Argument;
+    // Hand the slot back to producers for the next lap.
+    slot.Sequence = _dequeuePosition + WORK_QUEUE_ENTRIES;
+    _dequeuePosition++;
+    return true;
+}
+
+WorkQueue::WorkQueue()
+    : _rings(),
+      _procMgr(nullptr),
+      _workerThread()
+{
+}
+
+WorkQueue::~WorkQueue()
+{
+    // Intentionally do nothing.
+}
+
+void
+WorkQueue::Initialize(ProcessManager& procMgr, MemoryManager& memMgr)
+{
+    _procMgr = &procMgr;
+    _workerThread = Thread{*_procMgr->GetKernelProcess(), memMgr, WorkerThreadEntry};
+    _procMgr->RegisterThread(_workerThread);
+    // Work items are kernel code and may touch the hardware directly.
+    _workerThread.SetThreadMode(true, true);
+    _procMgr->SetThreadPriority(_workerThread, THREAD_PRIORITY_HIGHEST);
+    _procMgr->ReadyThread(_workerThread, false);
+}
+
+bool
+WorkQueue::Enqueue(const WorkPriority priority, const WorkFunction function, const uintptr_t argument)
+{
+    if (!_rings[static_cast<uint8_t>(priority)].Push(function, argument)) return false;
+    // Only the wakeup takes a critical section, and a short one.
+    _procMgr->NotifyThreadFromIsr(_workerThread, NotifyAction::SetBits, WORK_QUEUE_NOTIFY_BIT);
+    return true;
+}
+
+bool
+WorkQueue::RunBatch()
+{
+    uint32_t ran = 0;
+    while (ran < WORK_QUEUE_BATCH)
+    {
+        WorkFunction function = nullptr;
+        uintptr_t argument = 0;
+        bool found = false;
+        // Start from the most urgent queue each time, so urgent work never waits behind a batch of less urgent work.
+        for (WorkRing& ring : _rings)
+        {
+            found = ring.Pop(function, argument);
+            if (found) break;
+        }
+        if (!found) return false;
+
+        function(argument);
+        ran++;
+    }
+
+    for (const WorkRing& ring : _rings)
+    {
+        if (ring.HasPending()) return true;
+    }
+    return false;
+}
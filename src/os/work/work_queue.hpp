@@ -0,0 +1,104 @@
+#ifndef _WORK_QUEUE_H
+#define _WORK_QUEUE_H
+
+#include "thread.h"
+#include <cstdint>
+
+class MemoryManager;
+class ProcessManager;
+
+/* Deferred interrupt work ("bottom halves").
+ * An interrupt handler does the minimum in the handler and enqueues the rest as a function and argument.
+ * A kernel worker thread at THREAD_PRIORITY_HIGHEST drains the queues in batches, most urgent queue first.
+ * Enqueueing never masks interrupts: slots are claimed with exclusive load/store, so handlers can nest.
+ * Only handlers at or below the kernel's interrupt ceiling may enqueue, as the worker is woken through the kernel.
+ */
+
+// Slots in each queue. Must be a power of two.
+#define WORK_QUEUE_ENTRIES 16u
+// Most items the worker runs before letting other threads of its priority in.
+#define WORK_QUEUE_BATCH 8u
+
+static_assert((WORK_QUEUE_ENTRIES & (WORK_QUEUE_ENTRIES - 1u)) == 0, "Work queue size must be a power of two");
+
+using WorkFunction = void (*)(uintptr_t argument);
+
+enum class WorkPriority : uint8_t
+{
+    High,
+    Normal,
+    Low,
+    NUM_PRIORITIES,
+};
+
+/// @brief Bounded queue with any number of producers and one consumer, the worker thread.
+class WorkRing
+{
+    private:
+        class Slot
+        {
+            public:
+                /// @brief Position the slot is next written at, plus one once written and waiting to be run.
+                volatile uint32_t Sequence;
+                volatile WorkFunction Function;
+                volatile uintptr_t Argument;
+        };
+
+        Slot _slots[WORK_QUEUE_ENTRIES];
+        volatile uint32_t _enqueuePosition;
+        uint32_t _dequeuePosition;
+        volatile uint32_t _overflowCount;
+
+    public:
+        WorkRing();
+        WorkRing(const WorkRing&) = delete;
+        WorkRing(WorkRing&&) = delete;
+        ~WorkRing();
+        WorkRing& operator=(const WorkRing&) = delete;
+        WorkRing& operator=(WorkRing&&) = delete;
+
+        /// @brief Add an item. Safe against nested producers.
+        /// @return false, and counts an overflow, if the queue is full.
+        bool Push(const WorkFunction function, const uintptr_t argument);
+        /// @brief Take the oldest item. Only the worker thread may call this.
+        /// @return false if the queue is empty, or the oldest item is still being written by an interrupted producer.
+        bool Pop(WorkFunction& function, uintptr_t& argument);
+        /// @return Whether Pop would return an item.
+        bool HasPending() const { return _slots[_dequeuePosition & (WORK_QUEUE_ENTRIES - 1u)].Sequence == _dequeuePosition + 1; };
+        uint32_t GetOverflowCount() const { return _overflowCount; };
+};
+
+class WorkQueue
+{
+    private:
+        WorkRing _rings[static_cast<uint8_t>(WorkPriority::NUM_PRIORITIES)];
+        ProcessManager* _procMgr;
+        Thread _workerThread;
+
+    public:
+        WorkQueue();
+        WorkQueue(const WorkQueue&) = delete;
+        WorkQueue(WorkQueue&&) = delete;
+        ~WorkQueue();
+        WorkQueue& operator=(const WorkQueue&) = delete;
+        WorkQueue& operator=(WorkQueue&&) = delete;
+
+        /// @brief Create the worker thread in the kernel process and make it ready. Call after the process manager is set up.
+        void Initialize(ProcessManager& procMgr, MemoryManager& memMgr);
+
+        /// @brief Defer a call to the worker thread. For interrupt handlers at or below the kernel's interrupt ceiling.
+        /// @return false if the queue for this priority is full. The item is dropped and counted as an overflow.
+        bool Enqueue(const WorkPriority priority, const WorkFunction function, const uintptr_t argument);
+        /// @brief Run up to WORK_QUEUE_BATCH items, always from the most urgent non-empty queue. Worker thread only.
+        /// @return Whether items were left over.
+        bool RunBatch();
+        /// @return Number of items dropped because the queue for this priority was full.
+        uint32_t GetOverflowCount(const WorkPriority priority) const
+        {
+            return _rings[static_cast<uint8_t>(priority)].GetOverflowCount();
+        };
+};
+
+extern WorkQueue workQueue;
+
+#endif /* _WORK_QUEUE_H */